@@ -22,25 +22,178 @@
  * 4. MVV-LVA Move Ordering:
  * - "Most Valuable Victim - Least Valuable Aggressor".
  * - Prioritizes examining good captures first to improve pruning efficiency.
+ * - Captures that lose material by static exchange evaluation (SEE) are
+ * tried after the quiet moves; quiescence search skips them altogether.
+ * - Moves are scored once and picked best-first one at a time, so a node
+ * that cuts off after a move or two never sorts the rest.
+ *
+ * 5. Iterative Deepening:
+ * - Searches depth 1, 2, 3, ... until the time, node or depth limit is hit.
+ * - Each iteration seeds the next one's move ordering, and an interrupted
+ * iteration is thrown away, so a search can stop at any moment.
+ *
+ * 6. Transposition Table:
+ * - Positions reached through different move orders are searched once; stored
+ * bounds cut the search off and the stored best move is tried first.
+ *
+ * 7. Lazy SMP:
+ * - Extra threads search the same root independently, sharing nothing but the
+ * transposition table. Their results reach the main thread through TT cutoffs
+ * and move ordering; only the main thread's choice is played.
+ *
+ * 8. Killer Moves, History and Countermoves:
+ * - Quiet moves that caused a beta cutoff are remembered per ply (killers),
+ * per from/to square (history) and as the reply to the previous move
+ * (countermoves), so quiet moves are tried in a meaningful order.
+ *
+ * 9. Principal Variation Search:
+ * - Only the first move of a node is searched with the full window; the rest
+ * get a null window that merely proves them worse, and are re-searched only
+ * when that proof fails.
+ * - From depth ASPIRATION_MIN_DEPTH on, the root window is centred on the
+ * previous iteration's score and widened whenever the result falls outside.
+ *
+ * 10. Selectivity (see SearchParams):
+ * - Null-move pruning: if passing the turn still beats beta, the node is cut.
+ * - Late move reductions: late quiet moves are searched shallower first.
+ * - Reverse futility and futility pruning: near the leaves, nodes with an eval
+ * far above beta are cut, and quiet moves that cannot reach alpha are skipped.
+ *
+ * 11. Endgame Tablebases:
+ * - With Syzygy files loaded (see syzygy.h), positions with few enough pieces
+ * take their value from the WDL tables, and root moves that throw away the
+ * tablebase result are removed before the search starts (DTZ breaks ties).
+ *
+ * 12. Staged Move Picking:
+ * - Moves are generated into a per-ply buffer in stages: hash move, captures,
+ * killers, then quiet moves. A node that cuts off early never generates its
+ * quiet moves, and legality is only checked for moves that get searched.
+ *
+ * 13. MultiPV:
+ * - Each iteration searches the root once per requested line, excluding the
+ * moves earlier lines chose; all passes share the TT and the ordering tables,
+ * so the N best moves cost one search instead of N.
  * ======================================================================================
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
 #include <limits.h>
+#include <math.h>
+#include <pthread.h>
 
 #include "ai.h"
+#include "attacks.h"
 #include "eval.h"
 #include "game.h"
+#include "movegen.h"
+#include "see.h"
+#include "syzygy.h"
 #include "structs.h"
+#include "tt.h"
+#include "timer.h"
 
-/* * SEARCH_DEPTH: The fixed number of half-moves (plies) the engine searches.
- * Depth 6 allows the engine to see 3 full moves ahead for both sides.
- */
-#define SEARCH_DEPTH 6
-#define INFINITY_SCORE 1000000
-#define MATE_VALUE (INFINITY_SCORE - 1000)
+
+/* Search statistics (see SearchStats): STAT() statements vanish in NO_SEARCH_STATS builds */
+#ifdef NO_SEARCH_STATS
+#define STAT(statement) ((void)0)
+#else
+#define STAT(statement) ((void)(statement))
+#endif
+
+/* How many nodes pass between two clock / stop flag checks */
+#define STOP_CHECK_INTERVAL 1024
+
+/* History scores saturate at +/- this value; kept below the promotion score */
+#define HISTORY_MAX 8192
+
+/* Quiet moves remembered per node for the history penalty */
+#define MAX_QUIETS_TRIED 64
+
+/* Delta pruning: a QS capture must be able to lift the eval this close to alpha */
+#define DELTA_MARGIN 200
+
+/* Aspiration windows: first iteration that uses one, and its initial half-width */
+#define ASPIRATION_MIN_DEPTH 4
+#define ASPIRATION_WINDOW 25
+
+/* Size of the late move reduction table, by depth and by move number */
+#define LMR_TABLE_SIZE 64
+
+/* Per-search state handed down the recursion */
+typedef struct
+{
+    SearchLimits limits;
+    SearchParams params;
+    int lmrReductions[LMR_TABLE_SIZE][LMR_TABLE_SIZE]; // From params, by [depth][move number]
+    int64_t searchStart; // When findBestMove() was called
+    int64_t startTime;   // When the clock started: searchStart, or the end of pondering
+    int64_t deadline;    // 0 = no time limit (or still pondering)
+    bool pondering;      // limits.ponder was still set at the last look
+    uint64_t nodes;
+    uint64_t tbHits;
+    SearchStats stats;
+    bool stopped; // Set once any limit is hit; every level then unwinds
+
+    // Move buffers indexed by ply: each node generates into its own row, so
+    // no move list is ever copied or allocated during the search.
+    Move moves[MAX_PLY][MAX_MOVES_IN_LIST];
+    int scores[MAX_PLY][MAX_MOVES_IN_LIST];
+
+    // Quiet move ordering, learned from beta cutoffs during this search
+    Move killers[MAX_PLY][2];     // Two most recent cutoff moves per ply
+    int history[2][64][64];       // [color][from][to] butterfly history
+    Move counterMoves[64][64];    // Refutation of the previous move, by its [from][to]
+    Move currentMove[MAX_PLY];    // Move being searched at each ply
+} SearchContext;
+
+/* Order in which a node's moves are handed out (see nextMove) */
+typedef enum
+{
+    PICK_HASH,
+    PICK_GEN_NOISY,
+    PICK_NOISY,
+    PICK_REFUTATIONS,
+    PICK_GEN_QUIET,
+    PICK_QUIET,
+    PICK_BAD_NOISY,
+    PICK_DONE
+} PickStage;
+
+/* Staged move picker of one node */
+typedef struct
+{
+    PickStage stage;
+    const SearchContext *ctx;
+    BoardState *board;
+    Move hashMove;
+    Move refutations[3]; // Two killers and the countermove, tried after the captures
+    Move *moves;         // This ply's buffer: noisy moves first, quiet moves appended
+    int *scores;
+    int index; // Next move of the current stage
+    int end;   // One past the current stage's last move
+    int refutationIndex;
+    int badNoisy;    // Losing captures left for last: moves[badNoisy..noisyEnd)
+    int noisyEnd;
+} MovePicker;
+
+/* One search thread: its own board copy, root move list and results */
+typedef struct
+{
+    int id; // 0 = main thread
+    BoardState board;
+    MoveList rootMoves;
+    SearchContext ctx;
+    Move bestMove; // Result of the last completed iteration
+    int bestScore;
+    int completedDepth;
+    int lineCount;                   // Root moves ranked per iteration (MultiPV), at least 1
+    Move lineMoves[MAX_MULTI_PV];    // Last completed iteration's lines, best first;
+    int lineScores[MAX_MULTI_PV];    // they also head rootMoves in this order
+} SearchThread;
 
 /* -------------------------------------------------------------------------- */
 /* INTERNAL FUNCTION PROTOTYPES                                               */
@@ -48,23 +201,42 @@
 
 /* Core Search Logic */
 
-static int negamax(BoardState *board, int depth, int alpha, int beta, int ply);
-static int quiescence(BoardState *board, int alpha, int beta);
+static void initSearchThread(SearchThread *t, int id, const BoardState *board, const SearchLimits *limits,
+                             int64_t startTime);
+static void iterativeDeepening(SearchThread *t, int maxDepth);
+static void *helperThreadMain(void *arg);
+static int searchRoot(SearchContext *ctx, BoardState *board, MoveList *rootMoves, int first, int depth, int alpha,
+                      int beta, Move *bestMove);
+static void rankLines(SearchThread *t, const Move *moves, const int *scores);
+static int negamax(SearchContext *ctx, BoardState *board, int depth, int alpha, int beta, int ply);
+static int quiescence(SearchContext *ctx, BoardState *board, int alpha, int beta, int ply);
+static bool shouldStop(SearchContext *ctx);
+static bool updateClock(SearchContext *ctx);
+static void fillResult(const SearchThread *t, SearchResult *result, uint64_t nodes, uint64_t tbHits,
+                       const SearchStats *stats);
+static void mergeStats(SearchStats *into, const SearchStats *from);
+static bool canProbeTablebase(const SearchContext *ctx, const BoardState *board);
+static void filterRootMoves(SearchContext *ctx, BoardState *board, MoveList *rootMoves);
+static int extractPv(const BoardState *root, Move best, Move *pv, int max);
 
 /* Heuristics & Ordering */
 
-static int scoreMove(BoardState *board, Move m);
-static void scoreMoves(BoardState *board, MoveList *list);
+static int scoreMove(const SearchContext *ctx, BoardState *board, Move m, Move hashMove);
+static void scoreMoves(const SearchContext *ctx, BoardState *board, Move *moves, int *scores, int count,
+                       Move hashMove);
+static Move pickBest(Move *moves, int *scores, int index, int count);
+static void initPicker(MovePicker *picker, SearchContext *ctx, BoardState *board, int ply, Move hashMove,
+                       Move counterMove);
+static bool nextMove(MovePicker *picker, Move *move);
+static void updateQuietStats(SearchContext *ctx, BoardState *board, int ply, int depth, Move best,
+                             const Move *quiets, int quietCount);
+static int scoreToTT(int score, int ply);
+static int scoreFromTT(int score, int ply);
 
-/* Move Generation Helpers (Standard Chess Logic) */
+/* Draw Rules */
 
-static void generatePseudoLegalMoves(BoardState *board, MoveList *list);
-static void generatePawnMoves(BoardState *board, MoveList *list, int r, int c);
-static void generateKnightMoves(BoardState *board, MoveList *list, int r, int c);
-static void generateKingMoves(BoardState *board, MoveList *list, int r, int c);
-static void generateSlidingMoves(BoardState *board, MoveList *list, int r, int c);
-static void addMove(BoardState *board, MoveList *list, Move move);
 static bool isInsufficientMaterial(BoardState *board);
+static bool isRepetition(const BoardState *board, int ply);
 
 /* ========================================================================== */
 /* 1. ROOT MOVE SEARCH (Entry Point)                                          */
@@ -72,48 +244,477 @@ static bool isInsufficientMaterial(BoardState *board);
 
 /**
  * @brief Calculates the best move for the current player using NegaMax.
- * This function is the "Root" of the search tree.
+ * This function starts the helper threads (Lazy SMP) and runs the main
+ * thread's iterative deepening; the main thread's result is returned.
  * * @param board The current state of the game board.
  * @return The optimal Move found.
  */
-Move findBestMove(BoardState *board)
+Move findBestMove(BoardState *board, const SearchLimits *limits, SearchResult *result)
 {
-    Move bestMove;
-    bestMove.from = (Position){-1, -1}; // Initialize to invalid to detect errors
+    int64_t startTime = nowMs();
+    int maxDepth = (limits->depth > 0 && limits->depth < MAX_SEARCH_DEPTH) ? limits->depth : MAX_SEARCH_DEPTH;
 
-    // Initialize Alpha (Lower Bound) and Beta (Upper Bound)
-    int alpha = -INFINITY_SCORE;
-    int beta = INFINITY_SCORE;
-    int bestVal = -INFINITY_SCORE;
+    // Entries written by earlier searches start ageing out
+    if (!limits->keepGeneration)
+        ttNewSearch();
+
+    // 1. Main thread: the only one bound by the caller's limits
+    SearchThread mainThread;
+    initSearchThread(&mainThread, 0, board, limits, startTime);
+
+    // 2. Helpers share only the TT with it; they run until the main thread is done
+    int helperCount = (limits->threads > 1) ? limits->threads - 1 : 0;
+    if (helperCount > MAX_SEARCH_THREADS - 1)
+        helperCount = MAX_SEARCH_THREADS - 1;
+
+    atomic_bool helpersStop = false;
+    SearchLimits helperLimits = {maxDepth, 0, 0, &helpersStop, 1, limits->params, NULL, NULL, NULL, limits->multiPV, false};
+    SearchThread *helpers = NULL;
+    pthread_t *handles = NULL;
+    int started = 0;
+
+    if (helperCount > 0 && mainThread.rootMoves.count > 1)
+    {
+        helpers = malloc(sizeof(SearchThread) * (size_t)helperCount);
+        handles = malloc(sizeof(pthread_t) * (size_t)helperCount);
+        if (helpers && handles)
+        {
+            for (; started < helperCount; started++)
+            {
+                initSearchThread(&helpers[started], started + 1, board, &helperLimits, startTime);
+                if (pthread_create(&handles[started], NULL, helperThreadMain, &helpers[started]) != 0)
+                    break; // Run with however many threads we got
+            }
+        }
+    }
+
+    iterativeDeepening(&mainThread, maxDepth);
+
+    // 3. Stop and collect the helpers
+    atomic_store(&helpersStop, true);
+    uint64_t totalNodes = mainThread.ctx.nodes;
+    uint64_t totalTbHits = mainThread.ctx.tbHits;
+    SearchStats totalStats = mainThread.ctx.stats;
+    for (int i = 0; i < started; i++)
+    {
+        pthread_join(handles[i], NULL);
+        totalNodes += helpers[i].ctx.nodes;
+        totalTbHits += helpers[i].ctx.tbHits;
+        mergeStats(&totalStats, &helpers[i].ctx.stats);
+    }
+    free(helpers);
+    free(handles);
+
+    // Fail-safe: If no iteration completed (limit hit during depth 1), pick the first legal move.
+    if (IS_NO_MOVE(mainThread.bestMove) && mainThread.rootMoves.count > 0)
+    {
+        mainThread.bestMove = mainThread.rootMoves.moves[0];
+    }
+
+    if (result)
+        fillResult(&mainThread, result, totalNodes, totalTbHits, &totalStats);
+
+    return mainThread.bestMove;
+}
+
+/**
+ * @brief Prepares one thread's private copy of everything a search mutates.
+ */
+static void initSearchThread(SearchThread *t, int id, const BoardState *board, const SearchLimits *limits,
+                             int64_t startTime)
+{
+    t->id = id;
+    t->board = *board;
+    t->ctx = (SearchContext){0};
+    t->ctx.limits = *limits;
+    if (limits->params)
+        t->ctx.params = *limits->params;
+    else
+        initSearchParams(&t->ctx.params);
+    for (int d = 0; d < LMR_TABLE_SIZE; d++)
+        for (int m = 0; m < LMR_TABLE_SIZE; m++)
+            t->ctx.lmrReductions[d][m] = (d > 0 && m > 0 && t->ctx.params.lmrDivisor > 0)
+                                             ? (int)(log(d) * log(m) * 100.0 / t->ctx.params.lmrDivisor)
+                                             : 0;
+    t->ctx.searchStart = t->ctx.startTime = startTime;
+    t->ctx.pondering = limits->ponder && atomic_load(limits->ponder);
+    t->ctx.deadline = (limits->timeMs > 0 && !t->ctx.pondering) ? startTime + limits->timeMs : 0;
+    t->bestMove = NO_MOVE; // Initialize to invalid to detect errors
+    t->bestScore = 0;
+    t->completedDepth = 0;
+
+    // Generate all legal moves (once; every iteration reorders the same list)
+    generateAllLegalMoves(&t->board, &t->rootMoves);
+    if (canProbeTablebase(&t->ctx, &t->board))
+        filterRootMoves(&t->ctx, &t->board, &t->rootMoves);
+
+    t->lineCount = (limits->multiPV > 1) ? limits->multiPV : 1;
+    if (t->lineCount > MAX_MULTI_PV)
+        t->lineCount = MAX_MULTI_PV;
+    if (t->lineCount > t->rootMoves.count && t->rootMoves.count > 0)
+        t->lineCount = t->rootMoves.count;
+}
+
+/**
+ * @brief Iterative deepening loop for one thread.
+ * Odd-numbered helpers run one ply ahead of the main thread so the threads
+ * spread over different depths and fill the shared TT with different subtrees.
+ */
+static void iterativeDeepening(SearchThread *t, int maxDepth)
+{
+    SearchContext *ctx = &t->ctx;
+    int startDepth = 1 + (t->id & 1);
+
+    for (int depth = startDepth; depth <= maxDepth && t->rootMoves.count > 0; depth++)
+    {
+        Move iterationMoves[MAX_MULTI_PV];
+        int iterationScores[MAX_MULTI_PV];
+
+        // One pass per line; pass k searches only the root moves from index k on
+        for (int line = 0; line < t->lineCount; line++)
+        {
+            // Aspiration window around the line's last score; a full window until there is one
+            int delta = ASPIRATION_WINDOW;
+            int alpha = -INFINITY_SCORE;
+            int beta = INFINITY_SCORE;
+            if (depth >= ASPIRATION_MIN_DEPTH && t->completedDepth > 0)
+            {
+                alpha = t->lineScores[line] - delta;
+                beta = t->lineScores[line] + delta;
+            }
+
+            Move iterationBest;
+            int val;
+            for (;;)
+            {
+                iterationBest = NO_MOVE;
+                val = searchRoot(ctx, &t->board, &t->rootMoves, line, depth, alpha, beta, &iterationBest);
+                if (ctx->stopped)
+                    break;
+
+                // Outside the window the score is only a bound: widen towards it and retry
+                if (val <= alpha)
+                {
+                    beta = (alpha + beta) / 2;
+                    alpha = (val - delta > -INFINITY_SCORE) ? val - delta : -INFINITY_SCORE;
+                }
+                else if (val >= beta)
+                    beta = (val + delta < INFINITY_SCORE) ? val + delta : INFINITY_SCORE;
+                else
+                    break;
+                delta += delta / 2;
+            }
+            if (ctx->stopped)
+                break;
+
+            iterationMoves[line] = iterationBest;
+            iterationScores[line] = val;
+
+            // Later passes leave this move out: park it in front of the moves still to search
+            if (t->lineCount > 1)
+            {
+                int index = line;
+                while (!sameMove(t->rootMoves.moves[index], iterationBest))
+                    index++;
+                for (; index > line; index--)
+                    t->rootMoves.moves[index] = t->rootMoves.moves[index - 1];
+                t->rootMoves.moves[line] = iterationBest;
+            }
+        }
+
+        // An interrupted iteration may not have seen the best move: discard it
+        if (ctx->stopped)
+            break;
+
+        rankLines(t, iterationMoves, iterationScores);
+        t->completedDepth = depth;
+        ctx->stats.iterations = depth;
+        ctx->stats.iterationNodes[depth] = ctx->nodes;
+        ctx->stats.iterationMs[depth] = nowMs() - ctx->searchStart;
+
+        if (t->id == 0 && ctx->limits.report)
+        {
+            SearchResult progress;
+            fillResult(t, &progress, ctx->nodes, ctx->tbHits, &ctx->stats);
+            ctx->limits.report(&progress, ctx->limits.reportData);
+        }
+
+        // Only one legal reply: nothing to choose between
+        if (t->rootMoves.count == 1)
+            break;
+
+        // The next iteration costs several times this one; do not start what
+        // we likely cannot finish.
+        updateClock(ctx);
+        if (ctx->deadline && (nowMs() - ctx->startTime) * 2 > ctx->limits.timeMs)
+            break;
+    }
+}
+
+/**
+ * @brief Records an iteration's lines, best first. A later pass can come back
+ * higher than an earlier one (it ran with a better-filled TT), so the lines
+ * are sorted by score; rootMoves is reordered to match, which makes each
+ * line's move the one its pass tries first next iteration.
+ */
+static void rankLines(SearchThread *t, const Move *moves, const int *scores)
+{
+    for (int i = 0; i < t->lineCount; i++)
+    {
+        // Insertion sort: stable, so equal scores keep their search order
+        int j = i;
+        for (; j > 0 && scores[i] > t->lineScores[j - 1]; j--)
+        {
+            t->lineMoves[j] = t->lineMoves[j - 1];
+            t->lineScores[j] = t->lineScores[j - 1];
+        }
+        t->lineMoves[j] = moves[i];
+        t->lineScores[j] = scores[i];
+    }
+    if (t->lineCount > 1)
+        for (int i = 0; i < t->lineCount; i++)
+            t->rootMoves.moves[i] = t->lineMoves[i];
 
-    // 1. Generate all legal moves
-    MoveList legalMoves = generateAllLegalMoves(board);
+    t->bestMove = t->lineMoves[0];
+    t->bestScore = t->lineScores[0];
+}
 
-    // 2. Sort moves: Check Captures first!
+/**
+ * @brief Copies a thread's last completed iteration into 'result'.
+ */
+static void fillResult(const SearchThread *t, SearchResult *result, uint64_t nodes, uint64_t tbHits,
+                       const SearchStats *stats)
+{
+    result->bestMove = t->bestMove;
+    result->score = t->bestScore;
+    result->depth = t->completedDepth;
+    result->nodes = nodes;
+    result->tbHits = tbHits;
+    result->timeMs = nowMs() - t->ctx.searchStart;
+    result->pvLength = extractPv(&t->board, t->bestMove, result->pv, MAX_PV_LENGTH);
+    result->stats = *stats;
+
+    // Before the first iteration completes there is at most the fail-safe move
+    result->lineCount = (t->completedDepth > 0) ? t->lineCount : !IS_NO_MOVE(t->bestMove);
+    for (int i = 0; i < result->lineCount; i++)
+    {
+        SearchLine *line = &result->lines[i];
+        if (i == 0)
+        {
+            line->score = result->score;
+            line->pvLength = result->pvLength;
+            memcpy(line->pv, result->pv, sizeof(Move) * (size_t)result->pvLength);
+        }
+        else
+        {
+            line->score = t->lineScores[i];
+            line->pvLength = extractPv(&t->board, t->lineMoves[i], line->pv, MAX_PV_LENGTH);
+        }
+    }
+}
+
+/**
+ * @brief Adds a helper thread's counters to the totals (iterations stay the main thread's).
+ */
+static void mergeStats(SearchStats *into, const SearchStats *from)
+{
+    into->qsNodes += from->qsNodes;
+    into->ttProbes += from->ttProbes;
+    into->ttHits += from->ttHits;
+    into->ttCutoffs += from->ttCutoffs;
+    for (int i = 0; i < STATS_CUTOFF_SLOTS; i++)
+        into->betaCutoffs[i] += from->betaCutoffs[i];
+    if (from->selDepth > into->selDepth)
+        into->selDepth = from->selDepth;
+}
+
+double firstMoveCutoffRate(const SearchStats *stats)
+{
+    uint64_t total = 0;
+    for (int i = 0; i < STATS_CUTOFF_SLOTS; i++)
+        total += stats->betaCutoffs[i];
+    return total ? (double)stats->betaCutoffs[0] / (double)total : 0.0;
+}
+
+double effectiveBranchingFactor(const SearchStats *stats)
+{
+    int d = stats->iterations;
+    if (d < 3 || stats->iterationNodes[d - 2] == 0)
+        return 0.0;
+    // Nodes of each iteration alone: the counts are cumulative
+    uint64_t last = stats->iterationNodes[d] - stats->iterationNodes[d - 1];
+    uint64_t previous = stats->iterationNodes[d - 1] - stats->iterationNodes[d - 2];
+    return previous ? (double)last / (double)previous : 0.0;
+}
+
+/**
+ * @brief Follows the TT's best moves from the root to rebuild the expected line.
+ * Stops at the first move that is missing or not legal (entries may have been
+ * overwritten, or belong to a colliding position).
+ */
+static int extractPv(const BoardState *root, Move best, Move *pv, int max)
+{
+    BoardState board = *root;
+    Move move = best;
+    int length = 0;
+
+    while (length < max && !IS_NO_MOVE(move))
+    {
+        CheckInfo info;
+        computeCheckInfo(&board, &info);
+        if (!isPseudoLegal(&board, move) || !isLegalMove(&board, move, &info))
+            break;
+
+        pv[length++] = move;
+        MoveRecord undo;
+        makeMove(&board, move, &undo);
+
+        TTProbe tt;
+        ttProbe(board.hash, &tt);
+        move = tt.found ? tt.move : NO_MOVE;
+    }
+    return length;
+}
+
+/**
+ * @brief True if the position is small enough for the loaded tables and the
+ * probe limit. Tables assume no castling rights.
+ */
+static bool canProbeTablebase(const SearchContext *ctx, const BoardState *board)
+{
+    int largest = tbLargest();
+    if (largest == 0 || ctx->params.tbProbeLimit <= 0)
+        return false;
+    int pieces = popCount(board->occupiedBB);
+    return pieces <= largest && pieces <= ctx->params.tbProbeLimit && !board->castling.wk && !board->castling.wq &&
+           !board->castling.bk && !board->castling.bq;
+}
+
+/**
+ * @brief Keeps only the root moves that preserve the tablebase result: the
+ * best WDL class, and when winning the moves that still reach the next
+ * zeroing move within the 50-move rule, so the search cannot drift into a
+ * draw by it. Leaves the list untouched if any probe fails.
+ */
+static void filterRootMoves(SearchContext *ctx, BoardState *board, MoveList *rootMoves)
+{
+    int value[MAX_MOVES_IN_LIST]; // TBResult for us after the move
+    int rank[MAX_MOVES_IN_LIST];  // Plies from the root to the next zeroing move
+    int bestValue = TB_LOSS;
+
+    for (int i = 0; i < rootMoves->count; i++)
+    {
+        // From the move itself: makeMove() does not reset the clock on a single pawn push
+        Move move = rootMoves->moves[i];
+        bool zeroing = board->squares[SQ_ROW(move.to)][SQ_COL(move.to)].type != EMPTY ||
+                       move.flag == MOVE_EN_PASSANT || board->squares[SQ_ROW(move.from)][SQ_COL(move.from)].type == PAWN;
+        MoveRecord undo;
+        makeMove(board, move, &undo);
+        TBResult wdl;
+        int dtz;
+        bool found = tbProbeWdl(board, &wdl) && tbProbeDtz(board, &dtz);
+        undoMove(board, &undo);
+        if (!found)
+            return;
+        ctx->tbHits++;
+
+        // Our result is the negation of the opponent's; a winning capture or pawn move zeroes at once
+        value[i] = -(int)wdl;
+        rank[i] = (zeroing && value[i] > TB_DRAW) ? 1 : abs(dtz) + 1;
+        if (value[i] > bestValue)
+            bestValue = value[i];
+    }
+
+    // When winning, every move that converts before the 50-move rule; failing that, the quickest
+    int limit = INT_MAX;
+    if (bestValue > TB_DRAW)
+    {
+        int fastest = INT_MAX;
+        for (int i = 0; i < rootMoves->count; i++)
+            if (value[i] == bestValue && rank[i] < fastest)
+                fastest = rank[i];
+        limit = 100 - board->halfmoveClock;
+        if (fastest > limit)
+            limit = fastest;
+    }
+
+    int kept = 0;
+    for (int i = 0; i < rootMoves->count; i++)
+        if (value[i] == bestValue && rank[i] <= limit)
+            rootMoves->moves[kept++] = rootMoves->moves[i];
+    rootMoves->count = kept;
+}
+
+static void *helperThreadMain(void *arg)
+{
+    SearchThread *t = arg;
+    iterativeDeepening(t, t->ctx.limits.depth);
+    return NULL;
+}
+
+/**
+ * @brief One pass of an iteration at the root: searches rootMoves[first..] to 'depth'.
+ * With MultiPV, pass k > 0 excludes the moves the earlier passes chose
+ * (rootMoves[0..k)); it does not store the root in the TT, whose entry
+ * belongs to the best line.
+ * @param alpha, beta Aspiration window; a result outside it is only a bound.
+ * @param bestMove Receives the best root move of this pass.
+ * @return Score of bestMove (meaningless if ctx->stopped was set).
+ */
+static int searchRoot(SearchContext *ctx, BoardState *board, MoveList *rootMoves, int first, int depth, int alpha,
+                      int beta, Move *bestMove)
+{
+    int alphaOrig = alpha;
+    int bestVal = -INFINITY_SCORE;
+    Move *moves = rootMoves->moves + first;
+    int count = rootMoves->count - first;
+
+    // Sort moves: Previous best move, then Captures!
     // Finding a good move early allows Alpha-Beta to prune bad branches later.
-    scoreMoves(board, &legalMoves);
+    // A later pass starts with the move that held its slot last iteration.
+    Move hashMove = moves[0];
+    if (first == 0)
+    {
+        TTProbe tt;
+        ttProbe(board->hash, &tt);
+        hashMove = tt.found ? tt.move : NO_MOVE;
+    }
+    scoreMoves(ctx, board, moves, ctx->scores[0], count, hashMove);
 
-    // 3. Iterate through all root moves
-    for (int i = 0; i < legalMoves.count; i++)
+    // Iterate through all root moves (picking leaves the list sorted for the next iteration)
+    for (int i = 0; i < count; i++)
     {
-        Move currentMove = legalMoves.moves[i];
+        Move currentMove = pickBest(moves, ctx->scores[0], i, count);
 
-        makeMove(board, currentMove);
+        MoveRecord undo;
+        makeMove(board, currentMove, &undo);
+        ctx->currentMove[0] = currentMove;
 
         /* * RECURSIVE CALL (NegaMax Variant):
          * value = -negamax(...)
          * We flip the result because the opponent's score is bad for us.
          * We swap -beta and -alpha to reflect the perspective shift.
          */
-        int val = -negamax(board, SEARCH_DEPTH - 1, -beta, -alpha, 1);
+        int val;
+        if (i == 0)
+            val = -negamax(ctx, board, depth - 1, -beta, -alpha, 1);
+        else
+        {
+            val = -negamax(ctx, board, depth - 1, -alpha - 1, -alpha, 1);
+            if (val > alpha && val < beta)
+                val = -negamax(ctx, board, depth - 1, -beta, -alpha, 1);
+        }
 
-        undoMove(board, currentMove);
+        undoMove(board, &undo);
+
+        if (ctx->stopped)
+            return 0;
 
         // Update best move found so far
         if (val > bestVal)
         {
             bestVal = val;
-            bestMove = currentMove;
+            *bestMove = currentMove;
         }
 
         // Update Alpha (The best score we can guarantee)
@@ -121,15 +722,121 @@ Move findBestMove(BoardState *board)
         {
             alpha = val;
         }
+
+        // Fail high: the caller widens the window and searches again
+        if (alpha >= beta)
+            break;
     }
 
-    // Fail-safe: If no moves improved -INFINITY (rare/bug), pick the first legal move.
-    if (bestMove.from.row == -1 && legalMoves.count > 0)
+    // After a fail low no root move is known to be best, so keep the stored one
+    if (first > 0)
+        return bestVal;
+    if (bestVal <= alphaOrig)
+        ttStore(board->hash, NO_MOVE, scoreToTT(bestVal, 0), depth, TT_UPPER);
+    else
+        ttStore(board->hash, *bestMove, scoreToTT(bestVal, 0), depth, (bestVal >= beta) ? TT_LOWER : TT_EXACT);
+    return bestVal;
+}
+
+/**
+ * @brief Counts a node and reports whether any search limit has been reached.
+ * The clock and the external flag are only polled every STOP_CHECK_INTERVAL nodes.
+ */
+static bool shouldStop(SearchContext *ctx)
+{
+    ctx->nodes++;
+    if (ctx->stopped)
+        return true;
+
+    if (ctx->limits.nodes && ctx->nodes >= ctx->limits.nodes)
+        ctx->stopped = true;
+    else if (ctx->nodes % STOP_CHECK_INTERVAL == 0)
     {
-        bestMove = legalMoves.moves[0];
+        if (ctx->limits.stop && atomic_load(ctx->limits.stop))
+            ctx->stopped = true;
+        else if (updateClock(ctx) && ctx->deadline && nowMs() >= ctx->deadline)
+            ctx->stopped = true;
     }
+    return ctx->stopped;
+}
 
-    return bestMove;
+/**
+ * @brief Starts the clock once pondering has ended (the caller cleared limits.ponder).
+ * @return false while still pondering.
+ */
+static bool updateClock(SearchContext *ctx)
+{
+    if (ctx->pondering && !atomic_load(ctx->limits.ponder))
+    {
+        ctx->pondering = false;
+        ctx->startTime = nowMs();
+        if (ctx->limits.timeMs > 0)
+            ctx->deadline = ctx->startTime + ctx->limits.timeMs;
+    }
+    return !ctx->pondering;
+}
+
+void initSearchParams(SearchParams *params)
+{
+    params->nullMove = true;
+    params->nullMinDepth = 3;
+    params->nullReduction = 3;
+    params->nullDepthDivisor = 4;
+
+    params->lmr = true;
+    params->lmrMinDepth = 3;
+    params->lmrMinMoves = 3;
+    params->lmrDivisor = 200;
+
+    params->reverseFutility = true;
+    params->rfpDepth = 6;
+    params->rfpMargin = 90;
+
+    params->futility = true;
+    params->futilityDepth = 3;
+    params->futilityMargin = 110;
+
+    params->tbProbeLimit = TB_MAX_PIECES;
+}
+
+/* Name -> field table for setSearchParam() */
+static const struct
+{
+    const char *name;
+    size_t offset;
+    bool isSwitch; // bool field rather than int
+} searchParamTable[] = {
+    {"nullMove", offsetof(SearchParams, nullMove), true},
+    {"nullMinDepth", offsetof(SearchParams, nullMinDepth), false},
+    {"nullReduction", offsetof(SearchParams, nullReduction), false},
+    {"nullDepthDivisor", offsetof(SearchParams, nullDepthDivisor), false},
+    {"lmr", offsetof(SearchParams, lmr), true},
+    {"lmrMinDepth", offsetof(SearchParams, lmrMinDepth), false},
+    {"lmrMinMoves", offsetof(SearchParams, lmrMinMoves), false},
+    {"lmrDivisor", offsetof(SearchParams, lmrDivisor), false},
+    {"reverseFutility", offsetof(SearchParams, reverseFutility), true},
+    {"rfpDepth", offsetof(SearchParams, rfpDepth), false},
+    {"rfpMargin", offsetof(SearchParams, rfpMargin), false},
+    {"futility", offsetof(SearchParams, futility), true},
+    {"futilityDepth", offsetof(SearchParams, futilityDepth), false},
+    {"futilityMargin", offsetof(SearchParams, futilityMargin), false},
+    {"tbProbeLimit", offsetof(SearchParams, tbProbeLimit), false},
+};
+
+bool setSearchParam(SearchParams *params, const char *name, int value)
+{
+    for (size_t i = 0; i < sizeof(searchParamTable) / sizeof(searchParamTable[0]); i++)
+    {
+        if (strcmp(searchParamTable[i].name, name))
+            continue;
+        char *field = (char *)params + searchParamTable[i].offset;
+        if (searchParamTable[i].isSwitch)
+            *(bool *)field = value != 0;
+        else
+            *(int *)field = value;
+        return true;
+    }
+    return false;
 }
 
 /* ========================================================================== */
@@ -139,13 +846,20 @@ Move findBestMove(BoardState *board)
 /**
  * @brief Quiescence Search (NegaMax Style)
  * Called at the leaf nodes of the main search.
- * It continues searching ONLY capture moves to resolve tactical instability.
+ * It continues searching ONLY captures (and queen promotions) to resolve tactical instability.
  * * @param alpha Lower bound score.
  * @param beta Upper bound score.
+ * @param ply Distance from the root (selects the move buffer).
  * @return The evaluation score relative to the side to move.
  */
-static int quiescence(BoardState *board, int alpha, int beta)
+static int quiescence(SearchContext *ctx, BoardState *board, int alpha, int beta, int ply)
 {
+    if (shouldStop(ctx))
+        return 0;
+    STAT(ctx->stats.qsNodes++);
+    if (ply > ctx->stats.selDepth)
+        ctx->stats.selDepth = ply;
+
     // 1. STAND-PAT:
     // Get the static score of the board.
     // evaluateBoard() returns (White - Black).
@@ -156,33 +870,54 @@ static int quiescence(BoardState *board, int alpha, int beta)
         stand_pat = -stand_pat;
 
     // 2. Beta Cutoff: If standing pat is already too good, return beta.
-    if (stand_pat >= beta)
-        return beta;
+    // Past the last move buffer there is nothing left to do but stand pat.
+    if (stand_pat >= beta || ply >= MAX_PLY)
+        return (stand_pat >= beta) ? beta : stand_pat;
 
     // 3. Alpha Update: If standing pat is better than alpha, raise the floor.
     if (stand_pat > alpha)
         alpha = stand_pat;
 
-    // 4. GENERATE MOVES (Captures Only)
-    MoveList moves = generateAllLegalMoves(board);
-    scoreMoves(board, &moves);
+    // 4. GENERATE MOVES (Captures and Queen Promotions Only)
+    // Quiet moves are never generated here; the noisy moves are pseudo-legal
+    // and only checked for legality once they are about to be searched.
+    Move *moves = ctx->moves[ply];
+    int count = generateMoves(board, moves, GEN_NOISY);
+    scoreMoves(ctx, board, moves, ctx->scores[ply], count, NO_MOVE);
 
-    for (int i = 0; i < moves.count; i++)
+    CheckInfo checkInfo;
+    computeCheckInfo(board, &checkInfo);
+    for (int i = 0; i < count; i++)
     {
-        Move m = moves.moves[i];
+        Move m = pickBest(moves, ctx->scores[ply], i, count);
 
-        // FILTER: Check destination square.
-        // If empty and not En Passant, it's a Quiet move -> Skip it.
-        Piece target = board->squares[m.to.row][m.to.col];
-        if (target.type == EMPTY && m.flag != MOVE_EN_PASSANT)
+        // 5. SEE PRUNING: scoreMove() gave every losing capture a negative
+        // score, and moves come best first, so the rest all lose material.
+        if (ctx->scores[ply][i] < 0)
+            break;
+
+        // 6. DELTA PRUNING: even winning the captured piece for free would
+        // leave us below alpha (promotions can gain more, so keep them).
+        if (m.flag != MOVE_PROMOTION)
+        {
+            PieceType victim = (m.flag == MOVE_EN_PASSANT) ? PAWN : board->squares[SQ_ROW(m.to)][SQ_COL(m.to)].type;
+            if (stand_pat + seeValue[victim] + DELTA_MARGIN <= alpha)
+                continue;
+        }
+
+        if (!isLegalMove(board, m, &checkInfo))
             continue;
 
-        makeMove(board, m);
+        MoveRecord undo;
+        makeMove(board, m, &undo);
 
         // Recursion: -quiescence (Flip perspective)
-        int score = -quiescence(board, -beta, -alpha);
+        int score = -quiescence(ctx, board, -beta, -alpha, ply + 1);
+
+        undoMove(board, &undo);
 
-        undoMove(board, m);
+        if (ctx->stopped)
+            return 0;
 
         // Pruning
         if (score >= beta)
@@ -200,58 +935,193 @@ static int quiescence(BoardState *board, int alpha, int beta)
  * @param beta Best score minimizer can guarantee.
  * @return The evaluation score relative to the side to move.
  */
-static int negamax(BoardState *board, int depth, int alpha, int beta, int ply)
+static int negamax(SearchContext *ctx, BoardState *board, int depth, int alpha, int beta, int ply)
 {
-    // BASE CASE 1: Draw Rules (50-move rule or Insufficient Material)
-    if (board->halfmoveClock >= 100 || isInsufficientMaterial(board))
+    if (shouldStop(ctx))
+        return 0;
+    if (ply > ctx->stats.selDepth)
+        ctx->stats.selDepth = ply;
+
+    // BASE CASE 1: Draw Rules (50-move rule, Insufficient Material or Repetition)
+    if (board->halfmoveClock >= 100 || isInsufficientMaterial(board) || isRepetition(board, ply))
         return 0;
 
     // CHECK EXTENSION
     // If we are in check, we extend the search depth by 1.
     // This ensures we don't stop searching just before a checkmate.
-    bool inCheck = isKingInCheck(board, board->currentPlayer);
+    // The same check/pin information later filters the pseudo-legal moves.
+    CheckInfo checkInfo;
+    computeCheckInfo(board, &checkInfo);
+    bool inCheck = checkInfo.checkers != 0;
     if (inCheck)
     {
         depth++;
     }
 
     // BASE CASE 2: Depth Limit Reached -> Enter Quiescence Search
-    if (depth <= 0)
-        return quiescence(board, alpha, beta);
+    // (also when the ply-indexed move buffers run out)
+    if (depth <= 0 || ply >= MAX_PLY)
+        return quiescence(ctx, board, alpha, beta, ply);
+
+    // TRANSPOSITION TABLE PROBE
+    // A stored result from at least this depth can answer the node outright
+    // if its bound is tight enough for the current window.
+    int alphaOrig = alpha;
+    TTProbe tt;
+    ttProbe(board->hash, &tt);
+    STAT(ctx->stats.ttProbes++);
+    STAT(ctx->stats.ttHits += tt.found);
+    if (tt.found && tt.depth >= depth)
+    {
+        int ttScore = scoreFromTT(tt.score, ply);
+        if (tt.bound == TT_EXACT ||
+            (tt.bound == TT_LOWER && ttScore >= beta) ||
+            (tt.bound == TT_UPPER && ttScore <= alpha))
+        {
+            STAT(ctx->stats.ttCutoffs++);
+            return ttScore;
+        }
+    }
 
-    // Generate Moves
-    MoveList legalMoves = generateAllLegalMoves(board);
+    // TABLEBASE PROBE
+    // Right after a capture or pawn move the WDL tables know the exact result.
+    if (board->halfmoveClock == 0 && canProbeTablebase(ctx, board))
+    {
+        TBResult wdl;
+        if (tbProbeWdl(board, &wdl))
+        {
+            ctx->tbHits++;
+            // Cursed wins and blessed losses are draws under the 50-move rule
+            int score = (wdl == TB_WIN) ? TB_WIN_SCORE - ply : (wdl == TB_LOSS) ? -TB_WIN_SCORE + ply : 0;
+            ttStore(board->hash, NO_MOVE, scoreToTT(score, ply), depth, TT_EXACT);
+            return score;
+        }
+    }
 
-    // BASE CASE 3: End of Game (Checkmate or Stalemate)
-    if (legalMoves.count == 0)
+    // STATIC EVALUATION (input of the pruning decisions below, none of which
+    // apply in check or in PV nodes, where an exact score is wanted)
+    const SearchParams *params = &ctx->params;
+    bool pvNode = beta - alpha > 1;
+    PieceColor us = board->currentPlayer;
+    Move previous = ctx->currentMove[ply - 1];
+    int staticEval = 0;
+    if (!inCheck)
     {
-        if (inCheck)
-            // Checkmate: Return -MATE + ply.
-            // Faster mates (lower ply) result in higher scores for the winner.
-            return -MATE_VALUE + ply;
-        else
-            // Stalemate
+        staticEval = evaluateBoard(board);
+        if (us == BLACK)
+            staticEval = -staticEval;
+    }
+
+    // REVERSE FUTILITY PRUNING
+    // With few plies left, an eval this far above beta is very unlikely to
+    // drop below it, so fail high without searching.
+    if (params->reverseFutility && !pvNode && !inCheck && depth <= params->rfpDepth &&
+        abs(beta) < MATE_VALUE - MAX_PLY && staticEval - params->rfpMargin * depth >= beta)
+        return staticEval;
+
+    // NULL-MOVE PRUNING
+    // Let the opponent move twice: if a reduced search still fails high, a real
+    // move would too. Zugzwang guard: never with only king and pawns left, where
+    // passing can be the best move. Two null moves in a row prove nothing.
+    Bitboard pieces = board->colorBB[us] & ~(board->pieceBB[us][PAWN] | board->pieceBB[us][KING]);
+    if (params->nullMove && !pvNode && !inCheck && depth >= params->nullMinDepth && staticEval >= beta &&
+        pieces && !IS_NO_MOVE(previous))
+    {
+        int r = params->nullReduction + (params->nullDepthDivisor > 0 ? depth / params->nullDepthDivisor : 0);
+        MoveRecord undo;
+        makeNullMove(board, &undo);
+        ctx->currentMove[ply] = NO_MOVE;
+        int score = -negamax(ctx, board, depth - 1 - r, -beta, -beta + 1, ply + 1);
+        undoNullMove(board, &undo);
+
+        if (ctx->stopped)
             return 0;
+        // A mate found after passing is not a real mate
+        if (score >= beta)
+            return (score >= MATE_VALUE - MAX_PLY) ? beta : score;
     }
 
-    // Sort Moves (Captures first for pruning)
-    scoreMoves(board, &legalMoves);
+    // FUTILITY PRUNING (per move, below): quiet moves cannot lift the eval to alpha
+    bool futile = params->futility && !pvNode && !inCheck && depth <= params->futilityDepth &&
+                  abs(alpha) < MATE_VALUE - MAX_PLY && staticEval + params->futilityMargin * depth <= alpha;
 
     // RECURSION
+    // Moves arrive stage by stage and are only pseudo-legal: one that would
+    // leave our king attacked is skipped before it is played or counted.
+    MovePicker picker;
+    Move counterMove = ctx->counterMoves[previous.from][previous.to];
+    initPicker(&picker, ctx, board, ply, tt.found ? tt.move : NO_MOVE, counterMove);
+
+    Move quietsTried[MAX_QUIETS_TRIED];
+    int quietCount = 0;
+
+    int legalCount = 0;
     int maxVal = -INFINITY_SCORE;
+    Move bestMove = NO_MOVE;
+    Move move;
 
-    for (int i = 0; i < legalMoves.count; i++)
+    while (nextMove(&picker, &move))
     {
-        makeMove(board, legalMoves.moves[i]);
+        if (!isLegalMove(board, move, &checkInfo))
+            continue;
+        legalCount++;
+
+        bool quiet = !isNoisyMove(board, move);
+        MoveRecord undo;
+        makeMove(board, move, &undo);
+        ctx->currentMove[ply] = move;
+        bool givesCheck = isKingInCheck(board, board->currentPlayer);
+
+        // The first move is always searched, so a fully pruned node still has a score
+        if (futile && quiet && !givesCheck && legalCount > 1)
+        {
+            undoMove(board, &undo);
+            continue;
+        }
 
         // NegaMax Step: Flip alpha/beta, negate result.
-        int score = -negamax(board, depth - 1, -beta, -alpha, ply + 1);
+        // PVS: after the first move, a null window only checks for "better than alpha";
+        // a move that passes it inside a PV node is searched again with the real window.
+        int score;
+        if (legalCount == 1)
+            score = -negamax(ctx, board, depth - 1, -beta, -alpha, ply + 1);
+        else
+        {
+            // LMR: late quiet moves of a well-ordered list rarely turn out best,
+            // so try them shallower first and only search deeper if one surprises.
+            int r = 0;
+            if (params->lmr && quiet && !inCheck && !givesCheck && depth >= params->lmrMinDepth &&
+                legalCount > params->lmrMinMoves)
+            {
+                r = ctx->lmrReductions[depth < LMR_TABLE_SIZE ? depth : LMR_TABLE_SIZE - 1]
+                                      [legalCount < LMR_TABLE_SIZE ? legalCount : LMR_TABLE_SIZE - 1];
+                if (pvNode)
+                    r--;
+                if (r > depth - 2)
+                    r = depth - 2; // Never drop straight into quiescence
+                if (r < 0)
+                    r = 0;
+            }
+
+            score = -negamax(ctx, board, depth - 1 - r, -alpha - 1, -alpha, ply + 1);
+            if (r > 0 && score > alpha)
+                score = -negamax(ctx, board, depth - 1, -alpha - 1, -alpha, ply + 1);
+            if (score > alpha && score < beta)
+                score = -negamax(ctx, board, depth - 1, -beta, -alpha, ply + 1);
+        }
 
-        undoMove(board, legalMoves.moves[i]);
+        undoMove(board, &undo);
+
+        // Aborted: the score is garbage, make sure nothing gets stored
+        if (ctx->stopped)
+            return 0;
 
         // Track best score
         if (score > maxVal)
+        {
             maxVal = score;
+            bestMove = move;
+        }
 
         // Update Alpha
         if (score > alpha)
@@ -259,9 +1129,35 @@ static int negamax(BoardState *board, int depth, int alpha, int beta, int ply)
 
         // Beta Pruning: Opponent has a better option elsewhere.
         if (alpha >= beta)
+        {
+            STAT(ctx->stats.betaCutoffs[legalCount <= STATS_CUTOFF_SLOTS ? legalCount - 1 : STATS_CUTOFF_SLOTS - 1]++);
+            if (quiet)
+                updateQuietStats(ctx, board, ply, depth, move, quietsTried, quietCount);
             break;
+        }
+
+        if (quiet && quietCount < MAX_QUIETS_TRIED)
+            quietsTried[quietCount++] = move;
+    }
+
+    // BASE CASE 3: End of Game (Checkmate or Stalemate)
+    if (legalCount == 0)
+    {
+        if (inCheck)
+            // Checkmate: Return -MATE + ply.
+            // Faster mates (lower ply) result in higher scores for the winner.
+            return -MATE_VALUE + ply;
+        else
+            // Stalemate
+            return 0;
     }
 
+    // Remember the result: failing low only bounds the score from above,
+    // failing high only from below.
+    TTBound bound = (maxVal <= alphaOrig) ? TT_UPPER : (maxVal >= beta) ? TT_LOWER
+                                                                        : TT_EXACT;
+    ttStore(board->hash, bestMove, scoreToTT(maxVal, ply), depth, bound);
+
     return maxVal;
 }
 
@@ -269,351 +1165,285 @@ static int negamax(BoardState *board, int depth, int alpha, int beta, int ply)
 /* 3. HEURISTICS & HELPERS (MVV-LVA)                                          */
 /* ========================================================================== */
 
+/* Piece values used for ordering only, indexed by PieceType */
+static const int orderValue[7] = {0, 100, 320, 330, 500, 900, 20000};
+
 /**
  * @brief Assigns a score to a move for sorting purposes.
  * Uses MVV-LVA: Most Valuable Victim - Least Valuable Aggressor.
  * * @return Higher score = Better candidate to search first.
  */
-static int scoreMove(BoardState *board, Move m)
+static int scoreMove(const SearchContext *ctx, BoardState *board, Move m, Move hashMove)
 {
-    Piece target = board->squares[m.to.row][m.to.col];
+    // 0. HASH MOVE (best move from a previous search of this position)
+    if (sameMove(m, hashMove))
+        return 1000000;
+
+    PieceType victim = board->squares[SQ_ROW(m.to)][SQ_COL(m.to)].type;
+    if (m.flag == MOVE_EN_PASSANT)
+        victim = PAWN;
 
     // A. CAPTURES
-    if (target.type != EMPTY)
+    if (victim != EMPTY)
     {
-        int victimVal = 0;
-        int attackerVal = 0;
+        PieceType attacker = board->squares[SQ_ROW(m.from)][SQ_COL(m.from)].type;
 
-        switch (target.type)
-        {
-        case PAWN:
-            victimVal = 100;
-            break;
-        case KNIGHT:
-            victimVal = 320;
-            break;
-        case BISHOP:
-            victimVal = 330;
-            break;
-        case ROOK:
-            victimVal = 500;
-            break;
-        case QUEEN:
-            victimVal = 900;
-            break;
-        case KING:
-            victimVal = 20000;
-            break;
-        default:
-            break;
-        }
-
-        Piece attacker = board->squares[m.from.row][m.from.col];
-        switch (attacker.type)
-        {
-        case PAWN:
-            attackerVal = 100;
-            break;
-        case KNIGHT:
-            attackerVal = 320;
-            break;
-        case BISHOP:
-            attackerVal = 330;
-            break;
-        case ROOK:
-            attackerVal = 500;
-            break;
-        case QUEEN:
-            attackerVal = 900;
-            break;
-        case KING:
-            attackerVal = 20000;
-            break;
-        default:
-            break;
-        }
+        // Losing exchanges go last, the least bad first (negative scores).
+        int exchange = see(board, m);
+        if (exchange < 0)
+            return exchange;
 
         // Score Formula: Base 10000 + Victim - (Attacker / 10).
         // Dividing Attacker by 10 ensures the score stays positive and valid.
-        return 10000 + victimVal - (attackerVal / 10);
+        return 10000 + orderValue[victim] - (orderValue[attacker] / 10);
     }
 
     // B. PROMOTIONS (Always high priority)
     if (m.flag == MOVE_PROMOTION)
         return 9000;
 
-    // C. QUIET MOVES (Future: History Heuristic)
-    return 0;
+    // C. QUIET MOVES: how often this move has caused cutoffs (History Heuristic)
+    return ctx->history[board->currentPlayer][m.from][m.to];
 }
 
 /**
- * @brief Sorts moves in descending order using Bubble Sort.
+ * @brief Scores every move once; pickBest() then hands them out in order.
+ * 'scores' is scratch space for 'count' entries, parallel to 'moves'.
  */
-static void scoreMoves(BoardState *board, MoveList *list)
+static void scoreMoves(const SearchContext *ctx, BoardState *board, Move *moves, int *scores, int count,
+                       Move hashMove)
 {
-    int scores[MAX_MOVES_IN_LIST];
-    // Pre-calculate scores
-    for (int i = 0; i < list->count; i++)
-        scores[i] = scoreMove(board, list->moves[i]);
-
-    // Sort
-    for (int i = 0; i < list->count - 1; i++)
-    {
-        for (int j = 0; j < list->count - i - 1; j++)
-        {
-            if (scores[j] < scores[j + 1])
-            {
-                int tempScore = scores[j];
-                scores[j] = scores[j + 1];
-                scores[j + 1] = tempScore;
-                Move tempMove = list->moves[j];
-                list->moves[j] = list->moves[j + 1];
-                list->moves[j + 1] = tempMove;
-            }
-        }
-    }
+    for (int i = 0; i < count; i++)
+        scores[i] = scoreMove(ctx, board, moves[i], hashMove);
 }
 
-/* ========================================================================== */
-/* 4. MOVE GENERATION (Standard Logic - Unchanged)                            */
-/* ========================================================================== */
-
 /**
- * @brief Generates all fully legal moves (checks included).
+ * @brief Selection step: swaps the best-scored move of moves[index..count) into
+ * slot 'index' and returns it. Costs O(n) per move actually searched.
  */
-MoveList generateAllLegalMoves(BoardState *board)
+static Move pickBest(Move *moves, int *scores, int index, int count)
 {
-    MoveList pseudo;
-    pseudo.count = 0;
-    MoveList final;
-    final.count = 0;
-
-    generatePseudoLegalMoves(board, &pseudo);
-    PieceColor currentPlayer = board->currentPlayer;
+    int best = index;
+    for (int i = index + 1; i < count; i++)
+        if (scores[i] > scores[best])
+            best = i;
+
+    Move move = moves[best];
+    int score = scores[best];
+    moves[best] = moves[index];
+    scores[best] = scores[index];
+    moves[index] = move;
+    scores[index] = score;
+    return move;
+}
 
-    for (int i = 0; i < pseudo.count; i++)
-    {
-        Move m = pseudo.moves[i];
-        makeMove(board, m);
-        // Filter: If King is in check, discard the move
-        if (!isKingInCheck(board, currentPlayer))
-            final.moves[final.count++] = m;
-        undoMove(board, m);
-    }
-    return final;
+/* Moves a history entry towards +/-HISTORY_MAX; large entries change less ("gravity") */
+static void updateHistory(int *entry, int bonus)
+{
+    *entry += bonus - *entry * abs(bonus) / HISTORY_MAX;
 }
 
-// --- Dispatcher ---
-static void generatePseudoLegalMoves(BoardState *board, MoveList *list)
+/**
+ * @brief Learns from a quiet beta cutoff at 'ply': 'best' becomes a killer and
+ * the countermove of the previous move and gains history, while the quiet
+ * moves searched before it without success lose history.
+ */
+static void updateQuietStats(SearchContext *ctx, BoardState *board, int ply, int depth, Move best,
+                             const Move *quiets, int quietCount)
 {
-    PieceColor player = board->currentPlayer;
-    for (int r = 0; r < 8; r++)
+    if (!sameMove(best, ctx->killers[ply][0]))
     {
-        for (int c = 0; c < 8; c++)
-        {
-            Piece p = board->squares[r][c];
-            if (p.color == player)
-            {
-                switch (p.type)
-                {
-                case PAWN:
-                    generatePawnMoves(board, list, r, c);
-                    break;
-                case KNIGHT:
-                    generateKnightMoves(board, list, r, c);
-                    break;
-                case BISHOP:
-                case ROOK:
-                case QUEEN:
-                    generateSlidingMoves(board, list, r, c);
-                    break;
-                case KING:
-                    generateKingMoves(board, list, r, c);
-                    break;
-                default:
-                    break;
-                }
-            }
-        }
+        ctx->killers[ply][1] = ctx->killers[ply][0];
+        ctx->killers[ply][0] = best;
     }
+
+    Move previous = ctx->currentMove[ply - 1];
+    if (!IS_NO_MOVE(previous))
+        ctx->counterMoves[previous.from][previous.to] = best;
+
+    // Deeper cutoffs say more about a move; cap so one node cannot saturate the table
+    int bonus = depth * depth * 8;
+    if (bonus > HISTORY_MAX / 4)
+        bonus = HISTORY_MAX / 4;
+    int (*history)[64] = ctx->history[board->currentPlayer];
+    updateHistory(&history[best.from][best.to], bonus);
+    for (int i = 0; i < quietCount; i++)
+        updateHistory(&history[quiets[i].from][quiets[i].to], -bonus);
 }
 
-// --- Safe Adder ---
-static void addMove(BoardState *board, MoveList *list, Move move)
+/**
+ * @brief Prepares the staged picker of a node searched at 'ply'.
+ * @param hashMove TT move to try first (NO_MOVE if none); verified before use.
+ * @param counterMove Reply that refuted the previous move elsewhere (NO_MOVE if none).
+ * The ply's killers and the countermove are tried right after the captures.
+ */
+static void initPicker(MovePicker *picker, SearchContext *ctx, BoardState *board, int ply, Move hashMove,
+                       Move counterMove)
 {
-    int toR = move.to.row;
-    int toC = move.to.col;
-    if (toR < 0 || toR >= 8 || toC < 0 || toC >= 8)
-        return;
-    if (move.flag != MOVE_EN_PASSANT && board->squares[toR][toC].color == board->currentPlayer)
-        return;
-    list->moves[list->count++] = move;
+    picker->stage = PICK_HASH;
+    picker->ctx = ctx;
+    picker->board = board;
+    picker->hashMove = hashMove;
+    picker->refutations[0] = ctx->killers[ply][0];
+    picker->refutations[1] = ctx->killers[ply][1];
+    picker->refutations[2] = counterMove;
+    picker->moves = ctx->moves[ply];
+    picker->scores = ctx->scores[ply];
+    picker->index = 0;
+    picker->end = 0;
+    picker->refutationIndex = 0;
+    picker->badNoisy = 0;
+    picker->noisyEnd = 0;
 }
 
-// --- Piece Generators ---
-
-static void generatePawnMoves(BoardState *board, MoveList *list, int r, int c)
+/**
+ * @brief Hands out the next pseudo-legal move of the node, generating each
+ * stage only once the previous one is exhausted.
+ * The hash move, killers and countermove come from other positions, so they are checked
+ * with isPseudoLegal() and skipped when the generated stages reach them again.
+ * @return false once every move has been handed out.
+ */
+static bool nextMove(MovePicker *picker, Move *move)
 {
-    PieceColor player = board->currentPlayer;
-    int dir = (player == WHITE) ? -1 : 1;
-    int startRow = (player == WHITE) ? 6 : 1;
-    int promotionRank = (player == WHITE) ? 0 : 7;
-    Position from = {r, c};
+    const SearchContext *ctx = picker->ctx;
+    BoardState *board = picker->board;
 
-    // 1. Push
-    if (r + dir >= 0 && r + dir < 8 && board->squares[r + dir][c].type == EMPTY)
+    switch (picker->stage)
     {
-        if (r + dir == promotionRank)
+    case PICK_HASH:
+        picker->stage = PICK_GEN_NOISY;
+        if (!IS_NO_MOVE(picker->hashMove) && isPseudoLegal(board, picker->hashMove))
         {
-            addMove(board, list, (Move){from, {r + dir, c}, QUEEN, MOVE_PROMOTION});
-            addMove(board, list, (Move){from, {r + dir, c}, ROOK, MOVE_PROMOTION});
-            addMove(board, list, (Move){from, {r + dir, c}, BISHOP, MOVE_PROMOTION});
-            addMove(board, list, (Move){from, {r + dir, c}, KNIGHT, MOVE_PROMOTION});
+            *move = picker->hashMove;
+            return true;
         }
-        else
+        // fall through
+
+    case PICK_GEN_NOISY:
+        picker->end = generateMoves(board, picker->moves, GEN_NOISY);
+        scoreMoves(ctx, board, picker->moves, picker->scores, picker->end, NO_MOVE);
+        picker->noisyEnd = picker->end;
+        picker->stage = PICK_NOISY;
+        // fall through
+
+    case PICK_NOISY:
+        while (picker->index < picker->end)
         {
-            addMove(board, list, (Move){from, {r + dir, c}, EMPTY, MOVE_NORMAL});
+            Move m = pickBest(picker->moves, picker->scores, picker->index, picker->end);
+            // Best first: once one capture loses material, all the rest do too
+            if (picker->scores[picker->index] < 0)
+                break;
+            picker->index++;
+            if (!sameMove(m, picker->hashMove))
+            {
+                *move = m;
+                return true;
+            }
         }
-    }
+        picker->badNoisy = picker->index;
+        picker->stage = PICK_REFUTATIONS;
+        // fall through
+
+    case PICK_REFUTATIONS:
+        while (picker->refutationIndex < 3)
+        {
+            int i = picker->refutationIndex++;
+            Move m = picker->refutations[i];
+            if (IS_NO_MOVE(m) || sameMove(m, picker->hashMove) || isNoisyMove(board, m))
+                continue;
+            // The countermove may coincide with a killer
+            if (i == 2 && (sameMove(m, picker->refutations[0]) || sameMove(m, picker->refutations[1])))
+                continue;
+            if (isPseudoLegal(board, m))
+            {
+                *move = m;
+                return true;
+            }
+        }
+        picker->stage = PICK_GEN_QUIET;
+        // fall through
 
-    // 2. Double Push
-    if (r == startRow && board->squares[r + dir][c].type == EMPTY && board->squares[r + 2 * dir][c].type == EMPTY)
+    case PICK_GEN_QUIET:
     {
-        addMove(board, list, (Move){from, {r + 2 * dir, c}, EMPTY, MOVE_NORMAL});
+        // Quiet moves go behind the noisy ones in the same buffer
+        int count = generateMoves(board, picker->moves + picker->end, GEN_QUIET);
+        scoreMoves(ctx, board, picker->moves + picker->end, picker->scores + picker->end, count, NO_MOVE);
+        picker->index = picker->end;
+        picker->end += count;
+        picker->stage = PICK_QUIET;
     }
-    
-    // 3. Captures
-    int captureCols[] = {c - 1, c + 1};
-    for (int i = 0; i < 2; i++)
-    {
-        int newC = captureCols[i];
-        if (newC >= 0 && newC < 8)
+        // fall through
+
+    case PICK_QUIET:
+        while (picker->index < picker->end)
         {
-            Piece target = board->squares[r + dir][newC];
-            // Normal Capture
-            if (target.type != EMPTY && target.color != player)
+            Move m = pickBest(picker->moves, picker->scores, picker->index++, picker->end);
+            if (!sameMove(m, picker->hashMove) && !sameMove(m, picker->refutations[0]) &&
+                !sameMove(m, picker->refutations[1]) && !sameMove(m, picker->refutations[2]))
             {
-                if (r + dir == promotionRank)
-                {
-                    addMove(board, list, (Move){from, {r + dir, newC}, QUEEN, MOVE_PROMOTION});
-                    addMove(board, list, (Move){from, {r + dir, newC}, ROOK, MOVE_PROMOTION});
-                    addMove(board, list, (Move){from, {r + dir, newC}, BISHOP, MOVE_PROMOTION});
-                    addMove(board, list, (Move){from, {r + dir, newC}, KNIGHT, MOVE_PROMOTION});
-                }
-                else
-                {
-                    addMove(board, list, (Move){from, {r + dir, newC}, EMPTY, MOVE_NORMAL});
-                }
+                *move = m;
+                return true;
             }
-            // En Passant
-            if (r + dir == board->enPassantTarget.row && newC == board->enPassantTarget.col)
+        }
+        picker->stage = PICK_BAD_NOISY;
+        // fall through
+
+    case PICK_BAD_NOISY:
+        while (picker->badNoisy < picker->noisyEnd)
+        {
+            Move m = pickBest(picker->moves, picker->scores, picker->badNoisy++, picker->noisyEnd);
+            if (!sameMove(m, picker->hashMove))
             {
-                addMove(board, list, (Move){from, {r + dir, newC}, EMPTY, MOVE_EN_PASSANT});
+                *move = m;
+                return true;
             }
         }
+        picker->stage = PICK_DONE;
+        // fall through
+
+    case PICK_DONE:
+    default:
+        return false;
     }
 }
 
-static void generateKnightMoves(BoardState *board, MoveList *list, int r, int c)
+/*
+ * Mate and tablebase scores are relative to the root ("mate in N plies from
+ * here"), but a TT entry can be reached at any ply. Store them relative to
+ * the node instead and convert back on retrieval.
+ */
+static int scoreToTT(int score, int ply)
 {
-    int dR[] = {-2, -2, -1, -1, 1, 1, 2, 2};
-    int dC[] = {-1, 1, -2, 2, -2, 2, -1, 1};
-    for (int i = 0; i < 8; i++)
-        addMove(board, list, (Move){{r, c}, {r + dR[i], c + dC[i]}, EMPTY, MOVE_NORMAL});
+    if (!IS_DECISIVE_SCORE(score))
+        return score;
+    return score > 0 ? score + ply : score - ply;
 }
 
-static void generateKingMoves(BoardState *board, MoveList *list, int r, int c)
+static int scoreFromTT(int score, int ply)
 {
-    PieceColor player = board->currentPlayer;
-    PieceColor opponent = (player == WHITE) ? BLACK : WHITE;
-    int dR[] = {-1, -1, -1, 0, 0, 1, 1, 1};
-    int dC[] = {-1, 0, 1, -1, 1, -1, 0, 1};
-
-    // Normal moves
-    for (int i = 0; i < 8; i++)
-        addMove(board, list, (Move){{r, c}, {r + dR[i], c + dC[i]}, EMPTY, MOVE_NORMAL});
-
-    // Castling
-    if (isKingInCheck(board, player))
-        return;
-
-    if (player == WHITE)
-    {
-        if (board->castling.wk && board->squares[7][5].type == EMPTY && board->squares[7][6].type == EMPTY &&
-            !isSquareAttacked(board, 7, 5, opponent) && !isSquareAttacked(board, 7, 6, opponent))
-            addMove(board, list, (Move){{7, 4}, {7, 6}, EMPTY, MOVE_CASTLE_KING});
-        if (board->castling.wq && board->squares[7][1].type == EMPTY && board->squares[7][2].type == EMPTY &&
-            board->squares[7][3].type == EMPTY && !isSquareAttacked(board, 7, 2, opponent) && !isSquareAttacked(board, 7, 3, opponent))
-            addMove(board, list, (Move){{7, 4}, {7, 2}, EMPTY, MOVE_CASTLE_QUEEN});
-    }
-    else
-    {
-        if (board->castling.bk && board->squares[0][5].type == EMPTY && board->squares[0][6].type == EMPTY &&
-            !isSquareAttacked(board, 0, 5, opponent) && !isSquareAttacked(board, 0, 6, opponent))
-            addMove(board, list, (Move){{0, 4}, {0, 6}, EMPTY, MOVE_CASTLE_KING});
-        if (board->castling.bq && board->squares[0][1].type == EMPTY && board->squares[0][2].type == EMPTY &&
-            board->squares[0][3].type == EMPTY && !isSquareAttacked(board, 0, 2, opponent) && !isSquareAttacked(board, 0, 3, opponent))
-            addMove(board, list, (Move){{0, 4}, {0, 2}, EMPTY, MOVE_CASTLE_QUEEN});
-    }
+    if (!IS_DECISIVE_SCORE(score))
+        return score;
+    return score > 0 ? score - ply : score + ply;
 }
 
-static void generateSlidingMoves(BoardState *board, MoveList *list, int r, int c)
-{
-    Piece p = board->squares[r][c];
-    int dR[] = {-1, -1, 1, 1, -1, 1, 0, 0};
-    int dC[] = {-1, 1, -1, 1, 0, 0, -1, 1};
-    int startDir = (p.type == BISHOP) ? 0 : (p.type == ROOK) ? 4
-                                                             : 0;
-    int endDir = (p.type == BISHOP) ? 4 : (p.type == ROOK) ? 8
-                                                           : 8;
-
-    for (int i = startDir; i < endDir; i++)
-    {
-        for (int k = 1; k < 8; k++)
-        {
-            int newR = r + dR[i] * k;
-            int newC = c + dC[i] * k;
-            if (newR < 0 || newR >= 8 || newC < 0 || newC >= 8)
-                break;
-            Piece target = board->squares[newR][newC];
-            if (target.type == EMPTY)
-            {
-                addMove(board, list, (Move){{r, c}, {newR, newC}, EMPTY, MOVE_NORMAL});
-            }
-            else if (target.color != board->currentPlayer)
-            {
-                addMove(board, list, (Move){{r, c}, {newR, newC}, EMPTY, MOVE_NORMAL});
-                break;
-            }
-            else
-            {
-                break;
-            }
-        }
-    }
-}
+/* ========================================================================== */
+/* 4. DRAW RULES                                                              */
+/* ========================================================================== */
 
 // --- Insufficient Material (Draw) ---
 static bool isInsufficientMaterial(BoardState *board)
 {
-    int minorPieceCount = 0;
-
-    for (int r = 0; r < 8; r++)
+    // If there is a Pawn, Rook, or Queen, checkmate is definitely possible.
+    for (int color = WHITE; color <= BLACK; color++)
     {
-        for (int c = 0; c < 8; c++)
-        {
-            PieceType type = board->squares[r][c].type;
-
-            // If there is a Pawn, Rook, or Queen, checkmate is definitely possible.
-            if (type == PAWN || type == ROOK || type == QUEEN)
-                return false;
-
-            // Count Bishops and Knights
-            if (type == BISHOP || type == KNIGHT)
-                minorPieceCount++;
-        }
+        if (board->pieceBB[color][PAWN] | board->pieceBB[color][ROOK] | board->pieceBB[color][QUEEN])
+            return false;
     }
 
+    // Count Bishops and Knights
+    int minorPieceCount = popCount(board->pieceBB[WHITE][KNIGHT] | board->pieceBB[WHITE][BISHOP] |
+                                   board->pieceBB[BLACK][KNIGHT] | board->pieceBB[BLACK][BISHOP]);
+
     // Insufficient Material Scenarios:
     // 0 Minors: King vs King
     // 1 Minor:  King + Knight vs King  OR  King + Bishop vs King
@@ -623,4 +1453,29 @@ static bool isInsufficientMaterial(BoardState *board)
     // If there are 2 or more minor pieces (e.g., 2 Bishops, or 1 Knight each),
     // a mate is theoretically possible (or at least not strictly impossible by rule).
     return false;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Detects a repeated position, looking back no further than the last
+ * irreversible move (nothing before a capture or pawn move can recur).
+ * A repetition inside the search tree counts as a draw at once, since the
+ * side that steered into it can repeat again; positions from the game before
+ * the root must have occurred twice (threefold repetition).
+ */
+static bool isRepetition(const BoardState *board, int ply)
+{
+    int limit = (board->halfmoveClock < board->historyLength) ? board->halfmoveClock : board->historyLength;
+    if (limit >= KEY_HISTORY_SIZE)
+        limit = KEY_HISTORY_SIZE - 1;
+
+    // Only positions with the same side to move, at least two moves each ago
+    int seen = 0;
+    for (int back = 4; back <= limit; back += 2)
+    {
+        if (board->keyHistory[(board->historyLength - back) & (KEY_HISTORY_SIZE - 1)] != board->hash)
+            continue;
+        if (back <= ply || ++seen >= 2)
+            return true;
+    }
+    return false;
+}
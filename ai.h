@@ -1,20 +1,175 @@
 #ifndef AI_H
 #define AI_H
 
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include "structs.h"
 
+#define MAX_SEARCH_DEPTH 64
+#define DEFAULT_SEARCH_DEPTH 6
+#define MAX_SEARCH_THREADS 256
+
+#define INFINITY_SCORE 1000000
+#define MATE_VALUE (INFINITY_SCORE - 1000)
+#define MAX_PLY 128 // Deepest ply any line reaches, extensions included
+
+/* Tablebase wins score TB_WIN_SCORE - ply: below every mate, above every evaluation */
+#define TB_WIN_SCORE (MATE_VALUE - 2 * MAX_PLY)
+
+/* Mate in N plies scores MATE_VALUE - N; anything beyond this bound is a forced mate */
+#define IS_MATE_SCORE(score) ((score) > MATE_VALUE - MAX_PLY || (score) < -(MATE_VALUE - MAX_PLY))
+
+/* Mates and tablebase wins: scores that count plies from the root */
+#define IS_DECISIVE_SCORE(score) ((score) >= TB_WIN_SCORE - MAX_PLY || (score) <= -(TB_WIN_SCORE - MAX_PLY))
+
+#define MAX_PV_LENGTH 32
+#define MAX_MULTI_PV 64 // Most lines one search can return
+
+/**
+ * @brief Selective search settings. Each technique can be switched off on its
+ * own, and its thresholds changed, to measure what it is worth.
+ */
+typedef struct
+{
+    bool nullMove;        // Null-move pruning
+    int nullMinDepth;     // Lowest depth that tries a null move
+    int nullReduction;    // Base depth reduction R of the null-move search
+    int nullDepthDivisor; // R also grows by depth / nullDepthDivisor
+
+    bool lmr;          // Late move reductions
+    int lmrMinDepth;   // Lowest depth at which quiet moves are reduced
+    int lmrMinMoves;   // Moves searched at full depth before reductions start
+    int lmrDivisor;    // Reduction is log(depth) * log(moves) * 100 / lmrDivisor
+
+    bool reverseFutility; // Static null move: cut nodes whose eval is far above beta
+    int rfpDepth;         // Deepest depth it applies to
+    int rfpMargin;        // Centipawns required above beta per ply of depth
+
+    bool futility;      // Skip quiet moves that cannot raise the eval to alpha
+    int futilityDepth;  // Deepest depth it applies to
+    int futilityMargin; // Centipawns a quiet move may gain per ply of depth
+
+    int tbProbeLimit; // Probe Syzygy tables with at most this many pieces (0 = never)
+} SearchParams;
+
+/**
+ * @brief Fills 'params' with the tuned defaults (everything enabled).
+ */
+void initSearchParams(SearchParams *params);
+
+/**
+ * @brief Sets one field of 'params' by name (e.g. "lmrMinDepth"); booleans take 0 or 1.
+ * @return false if there is no such parameter.
+ */
+bool setSearchParam(SearchParams *params, const char *name, int value);
+
+struct SearchResult;
+
+/* Called by the main search thread after each completed iteration */
+typedef void (*SearchReport)(const struct SearchResult *result, void *data);
+
+/**
+ * @brief Budget for one search. A zero field means "no limit of that kind";
+ * the search ends when any set limit is reached.
+ */
+typedef struct
+{
+    int depth;                  // Deepest iteration to run (0 = MAX_SEARCH_DEPTH)
+    int64_t timeMs;             // Wall-clock budget in milliseconds
+    uint64_t nodes;             // Node budget
+    atomic_bool *stop;          // Optional flag another thread sets to abort the search
+    int threads;                // Search threads including the caller's (0 or 1 = single-threaded)
+    const SearchParams *params; // Selectivity settings (NULL = initSearchParams() defaults)
+    atomic_bool *ponder;        // Optional; while set the clock is not running (see below)
+    SearchReport report;        // Optional progress callback
+    void *reportData;           // Passed to 'report'
+    int multiPV;                // Best root moves to find, each with its own line (0 or 1 = just the best)
+    bool keepGeneration;        // The caller ran ttNewSearch() for several concurrent searches
+} SearchLimits;
+
+#define STATS_CUTOFF_SLOTS 8
+
+/**
+ * @brief What a search did, for judging move ordering and pruning changes.
+ * Building with NO_SEARCH_STATS (make NOSTATS=1) compiles the counters out
+ * of the search, leaving them zero; selDepth and the per-iteration figures
+ * are always kept.
+ */
+typedef struct
+{
+    uint64_t qsNodes;   // Quiescence nodes (included in the node count)
+    uint64_t ttProbes;  // Transposition table lookups in the main search
+    uint64_t ttHits;    // Lookups that found the position
+    uint64_t ttCutoffs; // Hits whose stored bound answered the node outright
+    uint64_t betaCutoffs[STATS_CUTOFF_SLOTS]; // Fail-highs by move number; the last slot counts all later ones
+    int selDepth;   // Deepest ply reached, quiescence included
+    int iterations; // Last depth recorded below
+    uint64_t iterationNodes[MAX_SEARCH_DEPTH + 1]; // Nodes searched when each depth finished (main thread)
+    int64_t iterationMs[MAX_SEARCH_DEPTH + 1];     // Time elapsed when each depth finished
+} SearchStats;
+
+/**
+ * @brief Share of beta cutoffs produced by the first move searched (0 without cutoffs).
+ */
+double firstMoveCutoffRate(const SearchStats *stats);
+
+/**
+ * @brief Effective branching factor: nodes of the last iteration over those of the one before.
+ * @return 0 until two iterations have been recorded.
+ */
+double effectiveBranchingFactor(const SearchStats *stats);
+
+/**
+ * @brief One line of a MultiPV search: pv[0] is the root move.
+ */
+typedef struct
+{
+    int score; // From the side to move's point of view
+    Move pv[MAX_PV_LENGTH];
+    int pvLength;
+} SearchLine;
+
+/**
+ * @brief Outcome of the last fully completed iteration.
+ */
+typedef struct SearchResult
+{
+    Move bestMove;
+    int score;      // From the side to move's point of view
+    int depth;      // Depth of the iteration that produced bestMove
+    uint64_t nodes; // Nodes visited by the whole search (all threads; main thread only in reports)
+    int64_t timeMs; // Time spent by the whole search
+    uint64_t tbHits; // Successful tablebase probes
+    Move pv[MAX_PV_LENGTH]; // Expected line, starting with bestMove (from the TT)
+    int pvLength;
+    SearchStats stats; // All threads' counters; main thread only in reports
+    SearchLine lines[MAX_MULTI_PV]; // Best first; lines[0] repeats bestMove, score and pv
+    int lineCount;                  // min(limits.multiPV, legal moves), 0 without a move
+} SearchResult;
+
 /**
  * @brief Finds the best move for the current player using the Negamax algorithm.
  *
- * This is the main entry point for the AI. It will search to a
- * predefined depth and return the optimal move it finds.
+ * This is the main entry point for the AI. It searches with iterative
+ * deepening (depth 1, 2, 3, ...) until a limit is hit, and returns the best
+ * move of the last iteration that finished; an interrupted iteration is
+ * discarded.
+ *
+ * MultiPV: with limits->multiPV = N > 1 every iteration searches the root
+ * N times, each time leaving out the moves already found, so one search
+ * yields the N best moves with their scores and lines. The passes share the
+ * TT and the ordering heuristics; only the first stores the root position.
+ *
+ * Pondering: when limits->ponder points to a set flag, the search runs
+ * without a clock until the flag is cleared ("ponderhit"); timeMs is then
+ * counted from that moment.
  *
  * @param board The current state of the game board.
+ * @param limits When to stop searching.
+ * @param result Optional; receives score, depth and node count.
  * @return The best Move found by the AI.
  */
-Move findBestMove(BoardState *board);
-
-/* Expose helper to allow callers to obtain the list of legal moves */
-MoveList generateAllLegalMoves(BoardState *board);
+Move findBestMove(BoardState *board, const SearchLimits *limits, SearchResult *result);
 
 #endif // AI_H
\ No newline at end of file
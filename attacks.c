@@ -0,0 +1,244 @@
+#include "attacks.h"
+#include <stdbool.h>
+#include <string.h>
+
+/*
+ * Table construction.
+ *
+ * For every square we walk the rays once per blocker subset (slow, but only at
+ * startup) to get the reference attack sets, then search for a magic number
+ * that maps each subset to a slot without destructive collisions. The search
+ * reseeds a fixed generator at the start of every row; the seeds below were
+ * picked offline because they reach working magics quickly, which keeps
+ * startup to a few tens of milliseconds. Tables are identical on every run.
+ */
+
+Bitboard knightAttacks[64];
+Bitboard kingAttacks[64];
+Bitboard pawnAttacks[2][64];
+
+Magic bishopMagics[64];
+Magic rookMagics[64];
+
+Bitboard betweenBB[64][64];
+Bitboard lineBB[64][64];
+
+// Sum over all squares of 2^popCount(mask) for each slider
+#define BISHOP_TABLE_SIZE 5248
+#define ROOK_TABLE_SIZE 102400
+
+static Bitboard bishopTable[BISHOP_TABLE_SIZE];
+static Bitboard rookTable[ROOK_TABLE_SIZE];
+
+static bool initialized = false;
+
+/* ---------- Helpers ---------- */
+
+static const int bishopDR[] = {-1, -1, 1, 1};
+static const int bishopDC[] = {-1, 1, -1, 1};
+static const int rookDR[] = {-1, 1, 0, 0};
+static const int rookDC[] = {0, 0, -1, 1};
+
+static bool onBoard(int r, int c)
+{
+    return (r >= 0 && r < 8 && c >= 0 && c < 8);
+}
+
+/* Set of squares reached by stepping once by each (dR, dC) offset */
+static Bitboard leaperMask(int sq, const int *dR, const int *dC, int n)
+{
+    Bitboard b = 0;
+    int r = SQ_ROW(sq), c = SQ_COL(sq);
+    for (int i = 0; i < n; i++)
+        if (onBoard(r + dR[i], c + dC[i]))
+            b |= BIT(SQ(r + dR[i], c + dC[i]));
+    return b;
+}
+
+/* Reference slider attacks: walk each ray until the first blocker (inclusive) */
+static Bitboard slidingAttacks(int sq, Bitboard occupied, const int *dR, const int *dC)
+{
+    Bitboard b = 0;
+    int r = SQ_ROW(sq), c = SQ_COL(sq);
+    for (int i = 0; i < 4; i++)
+    {
+        for (int k = 1; k < 8; k++)
+        {
+            int nR = r + dR[i] * k;
+            int nC = c + dC[i] * k;
+            if (!onBoard(nR, nC))
+                break;
+            b |= BIT(SQ(nR, nC));
+            if (occupied & BIT(SQ(nR, nC)))
+                break;
+        }
+    }
+    return b;
+}
+
+/* Blocker squares that can change the attack set: every ray square except the last */
+static Bitboard relevantMask(int sq, const int *dR, const int *dC)
+{
+    Bitboard b = 0;
+    int r = SQ_ROW(sq), c = SQ_COL(sq);
+    for (int i = 0; i < 4; i++)
+    {
+        for (int k = 1; k < 8; k++)
+        {
+            int nR = r + dR[i] * k;
+            int nC = c + dC[i] * k;
+            if (!onBoard(nR + dR[i], nC + dC[i]))
+                break;
+            b |= BIT(SQ(nR, nC));
+        }
+    }
+    return b;
+}
+
+/* Per-row generator seeds (row 0 = rank 8) */
+static const Bitboard bishopSeeds[8] = {276, 236, 147, 11, 47, 210, 26, 146};
+static const Bitboard rookSeeds[8] = {1776, 826, 3907, 2719, 2271, 2078, 3582, 30};
+
+/* xorshift64* — small, fast and good enough to find magics */
+static Bitboard randomState = 1;
+
+static Bitboard randomBitboard(void)
+{
+    randomState ^= randomState >> 12;
+    randomState ^= randomState << 25;
+    randomState ^= randomState >> 27;
+    return randomState * 2685821657736338717ULL;
+}
+
+/* Magics with few set bits collide less often, so AND three randoms together */
+static Bitboard sparseRandom(void)
+{
+    return randomBitboard() & randomBitboard() & randomBitboard();
+}
+
+/*
+ * Fill one slider's Magic entries and attack table.
+ * 'occupancy' and 'reference' are scratch buffers of 4096 entries.
+ */
+static void initSliderMagics(Magic *magics, Bitboard *table, const int *dR, const int *dC,
+                             const Bitboard *seeds)
+{
+    static Bitboard occupancy[4096];
+    static Bitboard reference[4096];
+    static int epoch[4096];
+    int attempt = 0;
+    Bitboard *next = table;
+
+    memset(epoch, 0, sizeof(epoch));
+
+    for (int sq = 0; sq < 64; sq++)
+    {
+        Magic *m = &magics[sq];
+        if (SQ_COL(sq) == 0)
+            randomState = seeds[SQ_ROW(sq)];
+        m->mask = relevantMask(sq, dR, dC);
+        m->shift = 64 - popCount(m->mask);
+        m->attacks = next;
+
+        // Enumerate every subset of the mask (Carry-Rippler trick)
+        int size = 0;
+        Bitboard subset = 0;
+        do
+        {
+            occupancy[size] = subset;
+            reference[size] = slidingAttacks(sq, subset, dR, dC);
+            size++;
+            subset = (subset - m->mask) & m->mask;
+        } while (subset);
+        next += size;
+
+#if defined(USE_PEXT) && defined(__BMI2__)
+        m->magic = 0;
+        for (int i = 0; i < size; i++)
+            m->attacks[magicIndex(m, occupancy[i])] = reference[i];
+#else
+        // Try candidates until every subset lands in a slot that is either
+        // fresh for this attempt or already holds the same attack set.
+        bool found = false;
+        while (!found)
+        {
+            do
+            {
+                m->magic = sparseRandom();
+            } while (popCount((m->mask * m->magic) >> 56) < 6);
+
+            attempt++;
+            found = true;
+            for (int i = 0; i < size; i++)
+            {
+                unsigned idx = magicIndex(m, occupancy[i]);
+                if (epoch[idx] < attempt)
+                {
+                    epoch[idx] = attempt;
+                    m->attacks[idx] = reference[i];
+                }
+                else if (m->attacks[idx] != reference[i])
+                {
+                    found = false;
+                    break;
+                }
+            }
+        }
+#endif
+    }
+}
+
+/* Lines and segments between square pairs, from the finished slider tables */
+static void initLines(void)
+{
+    for (int a = 0; a < 64; a++)
+    {
+        for (int b = 0; b < 64; b++)
+        {
+            betweenBB[a][b] = lineBB[a][b] = 0;
+            if (a == b)
+                continue;
+            if (bishopAttacks(a, 0) & BIT(b))
+            {
+                lineBB[a][b] = (bishopAttacks(a, 0) & bishopAttacks(b, 0)) | BIT(a) | BIT(b);
+                betweenBB[a][b] = bishopAttacks(a, BIT(b)) & bishopAttacks(b, BIT(a));
+            }
+            else if (rookAttacks(a, 0) & BIT(b))
+            {
+                lineBB[a][b] = (rookAttacks(a, 0) & rookAttacks(b, 0)) | BIT(a) | BIT(b);
+                betweenBB[a][b] = rookAttacks(a, BIT(b)) & rookAttacks(b, BIT(a));
+            }
+        }
+    }
+}
+
+/* ---------- Public API ---------- */
+
+void initAttacks(void)
+{
+    if (initialized)
+        return;
+
+    static const int knightDR[] = {-2, -2, -1, -1, 1, 1, 2, 2};
+    static const int knightDC[] = {-1, 1, -2, 2, -2, 2, -1, 1};
+    static const int kingDR[] = {-1, -1, -1, 0, 0, 1, 1, 1};
+    static const int kingDC[] = {-1, 0, 1, -1, 1, -1, 0, 1};
+    // White pawns move towards row 0, black pawns towards row 7
+    static const int whitePawnDR[] = {-1, -1};
+    static const int blackPawnDR[] = {1, 1};
+    static const int pawnDC[] = {-1, 1};
+
+    for (int sq = 0; sq < 64; sq++)
+    {
+        knightAttacks[sq] = leaperMask(sq, knightDR, knightDC, 8);
+        kingAttacks[sq] = leaperMask(sq, kingDR, kingDC, 8);
+        pawnAttacks[WHITE][sq] = leaperMask(sq, whitePawnDR, pawnDC, 2);
+        pawnAttacks[BLACK][sq] = leaperMask(sq, blackPawnDR, pawnDC, 2);
+    }
+
+    initSliderMagics(bishopMagics, bishopTable, bishopDR, bishopDC, bishopSeeds);
+    initSliderMagics(rookMagics, rookTable, rookDR, rookDC, rookSeeds);
+    initLines();
+
+    initialized = true;
+}
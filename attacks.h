@@ -0,0 +1,120 @@
+#ifndef ATTACKS_H
+#define ATTACKS_H
+
+#include "bitboard.h"
+#include "structs.h"
+
+/*
+ * Precomputed attack tables.
+ *
+ * Leapers (knight, king, pawn) use plain per-square masks. Sliders use magic
+ * bitboards: the relevant blockers of a square are hashed into a dense table
+ * of attack sets, so a bishop/rook/queen attack query is one multiply, one
+ * shift and one load. Building with -mbmi2 -DUSE_PEXT swaps the multiply-shift
+ * for the PEXT instruction and skips the magic number search at startup.
+ *
+ * initAttacks() must run once before any other function in the engine.
+ */
+
+typedef struct
+{
+    Bitboard mask;     // Relevant blocker squares (edges excluded)
+    Bitboard magic;    // Multiplier mapping blocker subsets to table slots
+    Bitboard *attacks; // This square's slice of the shared attack table
+    int shift;         // 64 - popCount(mask)
+} Magic;
+
+extern Bitboard knightAttacks[64];
+extern Bitboard kingAttacks[64];
+extern Bitboard pawnAttacks[2][64]; // [color][square]: squares a pawn on 'square' attacks
+
+extern Magic bishopMagics[64];
+extern Magic rookMagics[64];
+
+// For two squares on a common rank, file or diagonal (0 otherwise):
+extern Bitboard betweenBB[64][64]; // Squares strictly between them
+extern Bitboard lineBB[64][64];    // The whole line through both, edge to edge
+
+/**
+ * @brief Builds every attack table. Safe to call more than once.
+ */
+void initAttacks(void);
+
+#if defined(USE_PEXT) && defined(__BMI2__)
+#include <immintrin.h>
+static inline unsigned magicIndex(const Magic *m, Bitboard occupied)
+{
+    return (unsigned)_pext_u64(occupied, m->mask);
+}
+#else
+static inline unsigned magicIndex(const Magic *m, Bitboard occupied)
+{
+    return (unsigned)(((occupied & m->mask) * m->magic) >> m->shift);
+}
+#endif
+
+/**
+ * @brief Every square attacked by the pawns in 'pawns' (all of 'color'), set-wise.
+ */
+static inline Bitboard pawnSetAttacks(Bitboard pawns, PieceColor color)
+{
+    // White pawns capture towards row 0 (lower squares), Black towards row 7
+    if (color == WHITE)
+        return ((pawns & ~FILE_A_BB) >> 9) | ((pawns & ~FILE_H_BB) >> 7);
+    return ((pawns & ~FILE_A_BB) << 7) | ((pawns & ~FILE_H_BB) << 9);
+}
+
+static inline Bitboard bishopAttacks(int sq, Bitboard occupied)
+{
+    const Magic *m = &bishopMagics[sq];
+    return m->attacks[magicIndex(m, occupied)];
+}
+
+static inline Bitboard rookAttacks(int sq, Bitboard occupied)
+{
+    const Magic *m = &rookMagics[sq];
+    return m->attacks[magicIndex(m, occupied)];
+}
+
+static inline Bitboard queenAttacks(int sq, Bitboard occupied)
+{
+    return bishopAttacks(sq, occupied) | rookAttacks(sq, occupied);
+}
+
+/**
+ * @brief Attack set of a non-pawn piece type standing on 'sq'.
+ */
+static inline Bitboard pieceAttacks(PieceType type, int sq, Bitboard occupied)
+{
+    switch (type)
+    {
+    case KNIGHT:
+        return knightAttacks[sq];
+    case BISHOP:
+        return bishopAttacks(sq, occupied);
+    case ROOK:
+        return rookAttacks(sq, occupied);
+    case QUEEN:
+        return queenAttacks(sq, occupied);
+    case KING:
+        return kingAttacks[sq];
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Every piece of either color attacking 'sq', with 'occupied' as the blockers.
+ * Passing a modified occupancy answers "what if this piece moved away" questions.
+ */
+static inline Bitboard attackersTo(const BoardState *board, int sq, Bitboard occupied)
+{
+    const Bitboard(*p)[7] = board->pieceBB;
+    return (pawnAttacks[BLACK][sq] & p[WHITE][PAWN]) | (pawnAttacks[WHITE][sq] & p[BLACK][PAWN]) |
+           (knightAttacks[sq] & (p[WHITE][KNIGHT] | p[BLACK][KNIGHT])) |
+           (kingAttacks[sq] & (p[WHITE][KING] | p[BLACK][KING])) |
+           (bishopAttacks(sq, occupied) & (p[WHITE][BISHOP] | p[BLACK][BISHOP] | p[WHITE][QUEEN] | p[BLACK][QUEEN])) |
+           (rookAttacks(sq, occupied) & (p[WHITE][ROOK] | p[BLACK][ROOK] | p[WHITE][QUEEN] | p[BLACK][QUEEN]));
+}
+
+#endif // ATTACKS_H
@@ -0,0 +1,327 @@
+/*
+ * ======================================================================================
+ * File: batch.c
+ * Description: Parallel batch analysis of FEN/EPD streams (see batch.h).
+ *
+ * One reader (the calling thread) feeds a bounded queue; the workers share
+ * nothing but the queue, the output stream and - unless each has a private
+ * one - the transposition table. A worker's search keeps all of its state
+ * in its own SearchContext, so throughput grows with the worker count until
+ * memory bandwidth runs out.
+ * ======================================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "batch.h"
+#include "fileio.h"
+#include "game.h"
+#include "timer.h"
+#include "tt.h"
+#include "uci.h"
+
+#define BATCH_LINE_LENGTH 512   // Longer input lines are reported as errors
+#define BATCH_JOBS_PER_WORKER 4 // Queue depth: enough to never starve a worker
+
+typedef struct
+{
+    uint64_t id; // Input line number
+    bool tooLong;
+    char line[BATCH_LINE_LENGTH];
+} BatchJob;
+
+typedef struct
+{
+    const BatchOptions *options;
+
+    pthread_mutex_t lock; // Guards the queue
+    pthread_cond_t notEmpty;
+    pthread_cond_t notFull;
+    BatchJob *jobs; // Ring buffer
+    int capacity;
+    int head;
+    int count;
+    bool done; // The reader reached the end of the input
+
+    pthread_mutex_t outputLock; // Guards the output stream and the totals
+    FILE *out;
+    uint64_t positions;
+    uint64_t nodes;
+} BatchState;
+
+/* ---------- Queue ---------- */
+
+static void pushJob(BatchState *s, const BatchJob *job)
+{
+    pthread_mutex_lock(&s->lock);
+    while (s->count == s->capacity)
+        pthread_cond_wait(&s->notFull, &s->lock);
+    s->jobs[(s->head + s->count++) % s->capacity] = *job;
+    pthread_cond_signal(&s->notEmpty);
+    pthread_mutex_unlock(&s->lock);
+}
+
+/* Next job, or false once the input is exhausted */
+static bool popJob(BatchState *s, BatchJob *job)
+{
+    pthread_mutex_lock(&s->lock);
+    while (s->count == 0 && !s->done)
+        pthread_cond_wait(&s->notEmpty, &s->lock);
+    bool got = s->count > 0;
+    if (got)
+    {
+        *job = s->jobs[s->head];
+        s->head = (s->head + 1) % s->capacity;
+        s->count--;
+        pthread_cond_signal(&s->notFull);
+    }
+    pthread_mutex_unlock(&s->lock);
+    return got;
+}
+
+/* ---------- Output ---------- */
+
+/* Appends 'text' as a JSON string literal */
+static size_t appendJsonString(char *out, size_t size, size_t length, const char *text)
+{
+    if (length < size)
+        out[length++] = '"';
+    for (const char *c = text; *c && length + 7 < size; c++)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            out[length++] = '\\';
+            out[length++] = *c;
+        }
+        else if ((unsigned char)*c < 0x20)
+            length += (size_t)snprintf(out + length, size - length, "\\u%04x", (unsigned)*c);
+        else
+            out[length++] = *c;
+    }
+    if (length < size)
+        out[length++] = '"';
+    return length;
+}
+
+/* "cp":N, or "mate":N in moves (negative when the side to move is mated) */
+static void formatScore(int score, char *out, size_t size)
+{
+    bool mate;
+    int value = uciScoreValue(score, &mate);
+    snprintf(out, size, "\"%s\":%d", mate ? "mate" : "cp", value);
+}
+
+static void analyzeJob(BatchState *s, const SearchLimits *limits, const BatchJob *job, char *record, size_t size)
+{
+    size_t length = (size_t)snprintf(record, size, "{\"id\":%llu,\"position\":", (unsigned long long)job->id);
+    length = appendJsonString(record, size, length, job->line);
+
+    BoardState board;
+    const char *error = NULL;
+    if (job->tooLong)
+        error = "line too long";
+    else if (!loadBoardFromFEN(job->line, &board))
+        error = "invalid position";
+    else if (!isLegalPosition(&board)) // The search assumes both kings and no capturable one
+        error = "illegal position";
+    if (error)
+    {
+        snprintf(record + length, size - length, ",\"error\":\"%s\"}", error);
+        return;
+    }
+
+    SearchResult result;
+    Move best = findBestMove(&board, limits, &result);
+
+    char move[8] = "null";
+    if (!IS_NO_MOVE(best))
+    {
+        move[0] = '"';
+        moveToString(best, move + 1);
+        strcat(move, "\"");
+    }
+
+    char score[24];
+    formatScore(result.score, score, sizeof(score));
+    length += (size_t)snprintf(record + length, size - length, ",\"bestmove\":%s,%s,\"depth\":%d,\"nodes\":%llu,\"time\":%lld",
+                               move, score, result.depth, (unsigned long long)result.nodes, (long long)result.timeMs);
+
+    // MultiPV: every line with its score, best first
+    if (limits->multiPV > 1 && result.lineCount > 0 && length < size)
+    {
+        length += (size_t)snprintf(record + length, size - length, ",\"lines\":[");
+        for (int l = 0; l < result.lineCount && length < size; l++)
+        {
+            const SearchLine *line = &result.lines[l];
+            length += (size_t)snprintf(record + length, size - length, "%s{\"pv\":\"", l ? "," : "");
+            for (int i = 0; i < line->pvLength && length + 6 < size; i++)
+            {
+                moveToString(line->pv[i], move);
+                length += (size_t)snprintf(record + length, size - length, "%s%s", i ? " " : "", move);
+            }
+            formatScore(line->score, score, sizeof(score));
+            if (length < size)
+                length += (size_t)snprintf(record + length, size - length, "\",%s}", score);
+        }
+        if (length < size)
+            length += (size_t)snprintf(record + length, size - length, "]");
+    }
+    if (length < size)
+        snprintf(record + length, size - length, "}");
+
+    pthread_mutex_lock(&s->outputLock);
+    s->nodes += result.nodes;
+    pthread_mutex_unlock(&s->outputLock);
+}
+
+/* ---------- Workers ---------- */
+
+static void *batchWorker(void *arg)
+{
+    BatchState *s = arg;
+
+    // A private table keeps every search independent of the others (and of the input order)
+    TTTable *privateTable = NULL;
+    if (s->options->privateHashMB > 0)
+    {
+        privateTable = ttCreate(s->options->privateHashMB);
+        ttSelect(privateTable); // Falls back to the shared table if the allocation failed
+    }
+
+    SearchLimits limits = s->options->limits;
+    limits.threads = 1;
+    limits.stop = NULL;
+    limits.ponder = NULL;
+    limits.report = NULL;
+    limits.keepGeneration = !privateTable; // Shared table: runBatch() started one generation for all
+
+    BatchJob job;
+    char record[BATCH_LINE_LENGTH * 2 + 256 + MAX_MULTI_PV * (MAX_PV_LENGTH * 6 + 32)];
+    while (popJob(s, &job))
+    {
+        if (privateTable)
+            ttClear();
+        analyzeJob(s, &limits, &job, record, sizeof(record));
+
+        pthread_mutex_lock(&s->outputLock);
+        fprintf(s->out, "%s\n", record);
+        s->positions++;
+        pthread_mutex_unlock(&s->outputLock);
+    }
+
+    ttDestroy(privateTable);
+    return NULL;
+}
+
+/* ---------- Driver ---------- */
+
+/* Strips the line ending; false for lines that carry no position */
+static bool trimLine(char *line)
+{
+    size_t length = strlen(line);
+    while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r' || line[length - 1] == ' '))
+        line[--length] = '\0';
+    const char *start = line;
+    while (*start == ' ' || *start == '\t')
+        start++;
+    return *start && *start != '#';
+}
+
+int runBatch(const BatchOptions *options)
+{
+    FILE *in = options->input ? fopen(options->input, "r") : stdin;
+    if (!in)
+    {
+        fprintf(stderr, "Could not open %s\n", options->input);
+        return 1;
+    }
+    FILE *out = options->output ? fopen(options->output, "w") : stdout;
+    if (!out)
+    {
+        fprintf(stderr, "Could not create %s\n", options->output);
+        if (in != stdin)
+            fclose(in);
+        return 1;
+    }
+
+    int workers = options->workers < 1 ? 1 : options->workers;
+    BatchState s = {0};
+    s.options = options;
+    s.out = out;
+    s.capacity = workers * BATCH_JOBS_PER_WORKER;
+    s.jobs = malloc(sizeof(BatchJob) * (size_t)s.capacity);
+    pthread_t *threads = malloc(sizeof(pthread_t) * (size_t)workers);
+    if (!s.jobs || !threads)
+    {
+        free(s.jobs);
+        free(threads);
+        if (in != stdin)
+            fclose(in);
+        if (out != stdout)
+            fclose(out);
+        return 1;
+    }
+    pthread_mutex_init(&s.lock, NULL);
+    pthread_cond_init(&s.notEmpty, NULL);
+    pthread_cond_init(&s.notFull, NULL);
+    pthread_mutex_init(&s.outputLock, NULL);
+
+    // One generation for the whole batch: workers sharing the TT must not age out each other's entries
+    ttNewSearch();
+
+    int64_t start = nowMs();
+    int started = 0;
+    for (; started < workers; started++)
+        if (pthread_create(&threads[started], NULL, batchWorker, &s) != 0)
+            break;
+    if (started == 0)
+        fprintf(stderr, "Could not start any worker thread\n");
+
+    // Stream the input into the queue
+    BatchJob job;
+    uint64_t lineNumber = 0;
+    while (started > 0 && fgets(job.line, sizeof(job.line), in))
+    {
+        job.id = ++lineNumber;
+        job.tooLong = !strchr(job.line, '\n') && !feof(in);
+        if (job.tooLong)
+        {
+            // Skip the rest of the line
+            int c;
+            while ((c = fgetc(in)) != EOF && c != '\n')
+                ;
+        }
+        if (trimLine(job.line))
+            pushJob(&s, &job);
+    }
+
+    pthread_mutex_lock(&s.lock);
+    s.done = true;
+    pthread_cond_broadcast(&s.notEmpty);
+    pthread_mutex_unlock(&s.lock);
+    for (int i = 0; i < started; i++)
+        pthread_join(threads[i], NULL);
+
+    int64_t elapsed = nowMs() - start;
+    fflush(out);
+    fprintf(stderr, "Analyzed %llu positions with %d workers in %lld ms (%.1f positions/sec, %.0f nodes/sec)\n",
+            (unsigned long long)s.positions, started, (long long)elapsed,
+            elapsed > 0 ? (double)s.positions * 1000.0 / (double)elapsed : 0.0,
+            elapsed > 0 ? (double)s.nodes * 1000.0 / (double)elapsed : 0.0);
+
+    pthread_mutex_destroy(&s.lock);
+    pthread_cond_destroy(&s.notEmpty);
+    pthread_cond_destroy(&s.notFull);
+    pthread_mutex_destroy(&s.outputLock);
+    free(s.jobs);
+    free(threads);
+    if (in != stdin)
+        fclose(in);
+    if (out != stdout)
+        fclose(out);
+    return started > 0 ? 0 : 1;
+}
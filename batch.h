@@ -0,0 +1,39 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stddef.h>
+#include "ai.h"
+
+typedef struct
+{
+    const char *input;    // FEN/EPD lines to analyze; NULL reads stdin
+    const char *output;   // JSONL results; NULL writes stdout
+    int workers;          // Positions searched at once, one thread each
+    size_t privateHashMB; // Per-worker transposition table size; 0 = all share the main table
+    SearchLimits limits;  // Depth/node/time/MultiPV limits of every search (threads is ignored)
+} BatchOptions;
+
+/**
+ * @brief Offline analysis of a stream of positions.
+ *
+ * The calling thread reads the input line by line (blank lines and lines
+ * starting with '#' are skipped) into a bounded queue, so inputs of any size
+ * need constant memory. Each worker takes positions off the queue and runs
+ * an independent single-threaded search on its own board. One JSON object
+ * per position is written as soon as it is done, so results come out in
+ * completion order; "id" is the input line number:
+ *
+ *   {"id":3,"position":"<line>","bestmove":"e2e4","cp":31,"depth":10,"nodes":123456,"time":85}
+ *
+ * "mate" replaces "cp" for forced mates, "bestmove" is null without legal
+ * moves, and unreadable or illegal positions (not one king per side, or the
+ * side not to move in check) get an "error" field instead. With
+ * limits.multiPV > 1 a "lines" array follows, best first, each entry
+ * {"pv":"e2e4 e7e5 ...","cp":31}, all from the one search. A summary goes
+ * to stderr at the end.
+ *
+ * @return 0 on success, 1 if the input or output could not be opened or no worker started.
+ */
+int runBatch(const BatchOptions *options);
+
+#endif // BATCH_H
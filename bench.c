@@ -0,0 +1,258 @@
+/*
+ * ======================================================================================
+ * File: bench.c
+ * Description: Benchmark drivers run from the command line (see main.c).
+ * ======================================================================================
+ */
+
+#include <stdio.h>
+
+#include "bench.h"
+#include "ai.h"
+#include "fileio.h"
+#include "timer.h"
+#include "tt.h"
+#include "pawns.h"
+#include "game.h"
+#include "movegen.h"
+#include "eval.h"
+
+/* Middlegame-heavy set: SMP gains show up in wide trees, not in forced lines */
+static const char *smpPositions[] = {
+    START_FEN,
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+    "2rq1rk1/pp1bppbp/3p1np1/8/3NP3/1BN1BP2/PPPQ2PP/2KR3R b - - 0 13",
+};
+
+#define SMP_POSITION_COUNT (int)(sizeof(smpPositions) / sizeof(smpPositions[0]))
+
+int runSmpBench(int depth)
+{
+    static const int threadCounts[] = {1, 2, 4, 8, 16};
+    int64_t baseTime = 0;
+    double baseNps = 0;
+
+    printf("Lazy SMP scaling: %d positions, depth %d, %zu MB hash, %zu MB pawn hash\n\n", SMP_POSITION_COUNT, depth,
+           ttSizeMB(), pawnHashSizeMB());
+    printf("%8s %12s %14s %12s %10s %10s\n", "threads", "time (ms)", "nodes", "nodes/sec", "ttd gain", "nps gain");
+
+    for (size_t t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); t++)
+    {
+        SearchLimits limits = {depth, 0, 0, NULL, threadCounts[t], NULL, NULL, NULL, NULL, 1, false};
+        uint64_t nodes = 0;
+        int64_t elapsed = 0;
+
+        for (int i = 0; i < SMP_POSITION_COUNT; i++)
+        {
+            BoardState board;
+            SearchResult result;
+            loadBoardFromFEN(smpPositions[i], &board);
+            ttClear();
+            pawnHashClear();
+            findBestMove(&board, &limits, &result);
+            nodes += result.nodes;
+            elapsed += result.timeMs;
+        }
+
+        double nps = (elapsed > 0) ? (double)nodes * 1000.0 / (double)elapsed : 0.0;
+        if (t == 0)
+        {
+            baseTime = elapsed;
+            baseNps = nps;
+        }
+
+        printf("%8d %12lld %14llu %12.0f %9.2fx %9.2fx\n", threadCounts[t], (long long)elapsed,
+               (unsigned long long)nodes, nps, elapsed > 0 ? (double)baseTime / (double)elapsed : 0.0,
+               baseNps > 0 ? nps / baseNps : 0.0);
+    }
+
+    return 0;
+}
+
+/* ---------- Deterministic Bench ---------- */
+
+/* Openings, middlegames and endgames; never reorder or edit, or the signature changes */
+static const char *benchPositions[] = {
+    // Openings
+    START_FEN,
+    "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1",
+    "rnbqkbnr/pp1ppppp/8/2p5/4P3/5N2/PPPP1PPP/RNBQKB1R b KQkq - 1 2",
+    "rnbqkbnr/ppp2ppp/4p3/3p4/3PP3/8/PPP2PPP/RNBQKBNR w KQkq - 0 3",
+    "rnbqkbnr/pp2pppp/2p5/3p4/3PP3/8/PPP2PPP/RNBQKBNR w KQkq - 0 3",
+    "r1bqkbnr/pppp1ppp/2n5/1B2p3/4P3/5N2/PPPP1PPP/RNBQK2R b KQkq - 3 3",
+    "r1bqk1nr/pppp1ppp/2n5/2b1p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+    "rnbqkb1r/ppp2ppp/4pn2/3p4/2PP4/2N5/PP2PPPP/R1BQKBNR w KQkq - 2 4",
+    "rnbqk2r/ppp1ppbp/3p1np1/8/2PPP3/2N5/PP3PPP/R1BQKBNR w KQkq - 0 5",
+    "rnbqk2r/pppp1ppp/4pn2/8/1bPP4/2N5/PP2PPPP/R1BQKBNR w KQkq - 2 4",
+    "rnbqkb1r/pp3ppp/3p1n2/2pP4/8/2N5/PP2PPPP/R1BQKBNR w KQkq - 0 6",
+
+    // Middlegames
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 10",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "2rq1rk1/pp1bppbp/3p1np1/8/3NP3/1BN1BP2/PPPQ2PP/2KR3R b - - 0 13",
+    "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+    "rq3rk1/ppp2ppp/1bnpb3/3N2B1/3NP3/7P/PPPQ1PP1/2KR3R w - - 7 14",
+    "r1bq1r1k/1pp1n1pp/1p1p4/4p2Q/4Pp2/1BNP4/PPP2PPP/3R1RK1 w - - 2 14",
+    "r3r1k1/2p2ppp/p1p1bn2/8/1q2P3/2NPQN2/PPP3PP/R4RK1 b - - 2 15",
+    "r1bbk1nr/pp3p1p/2n5/1N4p1/2Np1B2/8/PPP2PPP/2KR1B1R w kq - 0 13",
+    "r1bq1rk1/ppp1nppp/4n3/3p3Q/3P4/1BP1B3/PP1N2PP/R4RK1 w - - 1 16",
+    "4r1k1/r1q2ppp/ppp2n2/4P3/5Rb1/1N1BQ3/PPP3PP/R5K1 w - - 1 17",
+    "2rqkb1r/ppp2p2/2npb1p1/1N1Nn2p/2P1PP2/8/PP2B1PP/R1BQK2R b KQ - 0 11",
+    "r1bq1r1k/b1p1npp1/p2p3p/1p6/3PP3/1B2NN2/PP3PPP/R2Q1RK1 w - - 1 16",
+    "3r1rk1/p5pp/bpp1pp2/8/q1PP1P2/b3P3/P2NQRPP/1R2B1K1 b - - 6 22",
+    "r1q2rk1/2p1bppp/2Pp4/p6b/Q1PNp3/4B3/PP1R1PPP/2K4R w - - 2 18",
+    "4k2r/1pb2ppp/1p2p3/1R1p4/3P4/2r1PN2/P4PPP/1R4K1 b - - 3 22",
+    "3q2k1/pb3p1p/4pbp1/2r5/PpN2N2/1P2P2P/5PP1/Q2R2K1 b - - 4 26",
+    "r2q1rk1/pp2bppp/2n1pn2/3p4/3P1B2/2PB1N2/PP1N1PPP/R2Q1RK1 w - - 4 10",
+    "r1b2rk1/2q1bppp/p2ppn2/1p6/3NP3/1BN1B3/PPP1QPPP/R4RK1 w - - 0 12",
+    "2r2rk1/1bqnbppp/p2ppn2/1p6/3NP3/P1N1BP2/1PPQB1PP/2KR3R w - - 2 14",
+
+    // Endgames
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 11",
+    "6k1/6p1/6Pp/ppp5/3pn2P/1P3K2/1PP2P2/8 b - - 3 54",
+    "8/k7/3p4/p2P1p2/P2P1P2/8/8/K7 w - - 0 1",
+    "6k1/5pp1/8/2bKP2P/2P5/p4PNb/B7/8 b - - 1 44",
+    "5k2/7R/4P2p/5K2/p1r2P1p/8/8/8 b - - 0 1",
+    "8/8/8/8/4k3/8/4P3/4K3 w - - 0 1",
+    "8/3k4/8/8/8/8/4R3/4K3 w - - 0 1",
+    "8/8/1p1k4/1P6/2K5/8/8/8 w - - 0 1",
+    "8/5pk1/6p1/7p/7P/6P1/5PK1/8 w - - 0 40",
+    "8/8/4kpp1/3p1b2/p6P/2B5/6P1/6K1 b - - 2 48",
+    "2r5/5pk1/6p1/3R3p/7P/6P1/5PK1/8 w - - 0 35",
+    "8/8/8/3k4/8/3K4/2Q5/8 w - - 0 1",
+    "8/8/3k4/8/8/2BBK3/8/8 w - - 0 1",
+    "8/1p4k1/p5p1/8/1P3P2/P5KP/8/8 w - - 0 45",
+    "8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1",
+    "4k3/8/8/8/8/8/PPPPPPPP/4K3 w - - 0 1",
+    "8/8/8/4N3/8/2k5/8/K1B5 w - - 0 1",
+};
+
+#define BENCH_POSITION_COUNT (int)(sizeof(benchPositions) / sizeof(benchPositions[0]))
+
+int runBench(int depth, const SearchParams *params)
+{
+    SearchLimits limits = {depth, 0, 0, NULL, 1, params, NULL, NULL, NULL, 1, false};
+    uint64_t nodes = 0;
+    int64_t elapsed = 0;
+
+    printf("Bench: %d positions, depth %d, %zu MB hash, %zu MB pawn hash\n\n", BENCH_POSITION_COUNT, depth,
+           ttSizeMB(), pawnHashSizeMB());
+    for (int i = 0; i < BENCH_POSITION_COUNT; i++)
+    {
+        BoardState board;
+        SearchResult result;
+        if (!loadBoardFromFEN(benchPositions[i], &board))
+        {
+            printf("Invalid bench position %d: %s\n", i + 1, benchPositions[i]);
+            return 1;
+        }
+        ttClear();
+        pawnHashClear();
+        findBestMove(&board, &limits, &result);
+        nodes += result.nodes;
+        elapsed += result.timeMs;
+        printf("%3d/%d %12llu nodes %8lld ms\n", i + 1, BENCH_POSITION_COUNT, (unsigned long long)result.nodes,
+               (long long)result.timeMs);
+    }
+
+    printf("\nTotal time (ms) : %lld\n", (long long)elapsed);
+    printf("Nodes searched  : %llu\n", (unsigned long long)nodes);
+    printf("Nodes/second    : %.0f\n", elapsed > 0 ? (double)nodes * 1000.0 / (double)elapsed : 0.0);
+    return 0;
+}
+
+/* ---------- Micro-benchmarks ---------- */
+
+// Passes over the position set per primitive, sized for a few hundred ms each
+#define MICRO_ROUNDS_MOVEGEN 20000
+#define MICRO_ROUNDS_MAKE 2000
+#define MICRO_ROUNDS_EVAL 50000
+#define MICRO_ROUNDS_ATTACKED 5000
+
+// Results are folded in here so the compiler cannot drop the calls
+static volatile uint64_t microSink;
+
+static void reportMicro(const char *name, uint64_t calls, int64_t elapsed)
+{
+    printf("%-22s %12llu calls %8lld ms %10.1f ns/call\n", name, (unsigned long long)calls, (long long)elapsed,
+           calls > 0 ? (double)elapsed * 1e6 / (double)calls : 0.0);
+}
+
+int runMicroBench(void)
+{
+    static BoardState boards[BENCH_POSITION_COUNT];
+    static MoveList moves[BENCH_POSITION_COUNT];
+    for (int i = 0; i < BENCH_POSITION_COUNT; i++)
+    {
+        if (!loadBoardFromFEN(benchPositions[i], &boards[i]))
+        {
+            printf("Invalid bench position %d: %s\n", i + 1, benchPositions[i]);
+            return 1;
+        }
+        generateAllLegalMoves(&boards[i], &moves[i]);
+    }
+    pawnHashClear();
+
+    printf("Micro-benchmarks over %d positions\n\n", BENCH_POSITION_COUNT);
+    uint64_t sink = 0, calls = 0;
+
+    // 1. Legal move generation
+    int64_t start = nowMs();
+    for (int round = 0; round < MICRO_ROUNDS_MOVEGEN; round++)
+        for (int i = 0; i < BENCH_POSITION_COUNT; i++)
+        {
+            MoveList list;
+            generateAllLegalMoves(&boards[i], &list);
+            sink += (uint64_t)list.count;
+            calls++;
+        }
+    reportMicro("generateAllLegalMoves", calls, nowMs() - start);
+
+    // 2. Make + undo of every legal move
+    calls = 0;
+    start = nowMs();
+    for (int round = 0; round < MICRO_ROUNDS_MAKE; round++)
+        for (int i = 0; i < BENCH_POSITION_COUNT; i++)
+            for (int m = 0; m < moves[i].count; m++)
+            {
+                MoveRecord record;
+                makeMove(&boards[i], moves[i].moves[m], &record);
+                sink += boards[i].hash;
+                undoMove(&boards[i], &record);
+                calls++;
+            }
+    reportMicro("makeMove + undoMove", calls, nowMs() - start);
+
+    // 3. Static evaluation (pawn structure comes from the pawn hash after the first round)
+    calls = 0;
+    start = nowMs();
+    for (int round = 0; round < MICRO_ROUNDS_EVAL; round++)
+        for (int i = 0; i < BENCH_POSITION_COUNT; i++)
+        {
+            sink += (uint64_t)evaluateBoard(&boards[i]);
+            calls++;
+        }
+    reportMicro("evaluateBoard", calls, nowMs() - start);
+
+    // 4. Attack test of every square by both colors
+    calls = 0;
+    start = nowMs();
+    for (int round = 0; round < MICRO_ROUNDS_ATTACKED; round++)
+        for (int i = 0; i < BENCH_POSITION_COUNT; i++)
+            for (int sq = 0; sq < 64; sq++)
+            {
+                sink += isSquareAttacked(&boards[i], SQ_ROW(sq), SQ_COL(sq), WHITE);
+                sink += isSquareAttacked(&boards[i], SQ_ROW(sq), SQ_COL(sq), BLACK);
+                calls += 2;
+            }
+    reportMicro("isSquareAttacked", calls, nowMs() - start);
+
+    microSink = sink;
+    return 0;
+}
@@ -0,0 +1,45 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "ai.h"
+
+#define SMP_BENCH_DEPTH 6
+#define BENCH_DEPTH 9
+
+/**
+ * @brief Lazy SMP scaling benchmark.
+ *
+ * Searches a fixed set of positions to 'depth' with 1, 2, 4, 8 and 16
+ * threads (clearing the TT before each run) and prints nodes/sec and
+ * time-to-depth for every thread count, relative to one thread.
+ *
+ * @param depth Depth every position is searched to.
+ * @return 0 on success.
+ */
+int runSmpBench(int depth);
+
+/**
+ * @brief Deterministic search benchmark.
+ *
+ * Searches a fixed set of 50 positions (openings, middlegames, endgames)
+ * to 'depth' on one thread, clearing the hash tables before each, and
+ * prints the total node count and nodes/sec. With the default depth,
+ * parameters and hash size the node count is a functional signature of
+ * the search: it changes exactly when the search's behaviour does.
+ *
+ * @param depth Depth every position is searched to.
+ * @param params Search parameters (NULL = defaults).
+ * @return 0 on success.
+ */
+int runBench(int depth, const SearchParams *params);
+
+/**
+ * @brief Micro-benchmarks of the hot primitives over the bench positions:
+ * legal move generation, makeMove/undoMove, evaluateBoard and isSquareAttacked.
+ * Prints the time per call of each.
+ *
+ * @return 0 on success.
+ */
+int runMicroBench(void);
+
+#endif // BENCH_H
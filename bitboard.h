@@ -0,0 +1,71 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdint.h>
+
+/*
+ * Bitboard helpers.
+ *
+ * Square numbering follows the mailbox layout used everywhere else:
+ * square = row * 8 + col, so a8 = 0, h8 = 7, a1 = 56 and h1 = 63.
+ * Bit N of a bitboard is set when square N is part of the set.
+ */
+
+typedef uint64_t Bitboard;
+
+#define SQ(r, c) ((r) * 8 + (c))
+#define SQ_ROW(sq) ((sq) >> 3)
+#define SQ_COL(sq) ((sq) & 7)
+#define BIT(sq) (1ULL << (sq))
+
+#define FILE_A_BB 0x0101010101010101ULL // Column 0
+#define FILE_H_BB 0x8080808080808080ULL // Column 7
+
+/**
+ * @brief Number of set bits (pieces) in a bitboard.
+ */
+static inline int popCount(Bitboard b)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(b);
+#else
+    int count = 0;
+    while (b)
+    {
+        b &= b - 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+/**
+ * @brief Index of the lowest set bit. The bitboard must not be empty.
+ */
+static inline int lsb(Bitboard b)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(b);
+#else
+    int sq = 0;
+    while (!(b & 1))
+    {
+        b >>= 1;
+        sq++;
+    }
+    return sq;
+#endif
+}
+
+/**
+ * @brief Returns the lowest set bit and clears it from the bitboard.
+ * Used to iterate over every piece of a set: while (bb) { int sq = popLsb(&bb); ... }
+ */
+static inline int popLsb(Bitboard *b)
+{
+    int sq = lsb(*b);
+    *b &= *b - 1;
+    return sq;
+}
+
+#endif // BITBOARD_H
@@ -0,0 +1,58 @@
+#ifndef BOOK_H
+#define BOOK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "structs.h"
+
+/*
+ * Polyglot opening book.
+ *
+ * A .bin book is an array of 16-byte big-endian entries (key, move, weight,
+ * learn) sorted by position key. The file is memory-mapped and looked up by
+ * binary search, so a probe costs a few page touches rather than a search,
+ * and the book is never copied into the process.
+ *
+ * Keys follow the Polyglot layout (781 random numbers: 12 x 64 piece-square
+ * keys, 4 castling keys, 8 en passant files and the side to move), with
+ * the constants of the Polyglot specification, so books made by other tools
+ * can be used as they are.
+ */
+
+/**
+ * @brief Maps the book at 'path', replacing any book already open.
+ * @return false if the file cannot be read or is not a whole number of entries.
+ */
+bool bookInit(const char *path);
+
+/**
+ * @brief Closes the book (no-op when none is open).
+ */
+void bookFree(void);
+
+/**
+ * @brief Whether a book is open.
+ */
+bool bookLoaded(void);
+
+/**
+ * @brief Polyglot key of the position.
+ */
+uint64_t polyglotKey(const BoardState *board);
+
+/**
+ * @brief Checks polyglotKey() against the reference keys of the Polyglot specification.
+ * @return false (after printing the mismatches) if any key differs.
+ */
+bool bookCheckKeys(void);
+
+/**
+ * @brief Picks a book move for the position, at random in proportion to the entry weights.
+ * Entries that are not legal in the position are ignored.
+ * @param random Caller-owned random state, so callers on different threads
+ *               never share one; 0 seeds it from the clock on first use.
+ * @return false if the position is not in the book.
+ */
+bool bookProbe(const BoardState *board, uint64_t *random, Move *move);
+
+#endif // BOOK_H
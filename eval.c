@@ -1,5 +1,11 @@
+#include <assert.h>
+#include <stddef.h>
+
 #include "eval.h"
 #include "structs.h"
+#include "attacks.h"
+#include "pawns.h"
+#include "nnue.h"
 
 /* * ============================================================================
  * TAPERED EVALUATION IMPLEMENTATION
@@ -170,6 +176,17 @@ static const int king_eg[8][8] = {
     {-50, -30, -30, -30, -30, -30, -30, -50} // Back rank is bad in endgame
 };
 
+// --- Incremental Tables ---
+
+int psqtMg[2][7][64];
+int psqtEg[2][7][64];
+
+// Phase contribution per PieceType (see the weights above)
+const int phaseWeight[7] = {0, 0, 1, 1, 2, 4, 0};
+
+static const int (*const mgTables[7])[8] = {NULL, pawn_mg, knight_mg, bishop_mg, rook_mg, queen_mg, king_mg};
+static const int (*const egTables[7])[8] = {NULL, pawn_eg, knight_eg, bishop_eg, rook_eg, queen_eg, king_eg};
+
 // --- Helpers ---
 
 // Retrieve table value based on piece type, phase (mg/eg), and color
@@ -180,153 +197,129 @@ static int getTableScore(const int table[8][8], int r, int c, PieceColor color)
     return table[row][col];
 }
 
-// --- Mobility Logic ---
-static int countSlidingMoves(BoardState *board, int r, int c, Piece p)
+// --- Attack Maps ---
+
+/*
+ * Everything eval learns about who attacks what, built once per call. Each
+ * piece's attack set is looked up exactly once; mobility reads it immediately
+ * and later terms (king safety, threats) can reuse the maps without walking
+ * the board again.
+ */
+typedef struct
+{
+    Bitboard attacks[2][7];   // [color][PieceType]: squares attacked by pieces of that type
+    Bitboard attackedBy[2];   // Union over all piece types
+    Bitboard mobilityArea[2]; // Squares counted for mobility: not occupied by own pieces
+} EvalInfo;
+
+// Pawn and king attacks, set-wise; pieces are filled in by evaluatePieces()
+static void initEvalInfo(const BoardState *board, EvalInfo *ei)
+{
+    for (int color = WHITE; color <= BLACK; color++)
+    {
+        for (int type = EMPTY; type <= KING; type++)
+            ei->attacks[color][type] = 0;
+        ei->mobilityArea[color] = ~board->colorBB[color];
+    }
+
+    ei->attacks[WHITE][PAWN] = pawnSetAttacks(board->pieceBB[WHITE][PAWN], WHITE);
+    ei->attacks[BLACK][PAWN] = pawnSetAttacks(board->pieceBB[BLACK][PAWN], BLACK);
+
+    for (int color = WHITE; color <= BLACK; color++)
+    {
+        if (board->kingSq[color] >= 0)
+            ei->attacks[color][KING] = kingAttacks[board->kingSq[color]];
+        ei->attackedBy[color] = ei->attacks[color][PAWN] | ei->attacks[color][KING];
+    }
+}
+
+// Knights, bishops, rooks and queens: records their attacks and scores mobility
+static void evaluatePieces(const BoardState *board, EvalInfo *ei, int *mgScore, int *egScore)
 {
-    int count = 0;
-    int dR[] = {-1, -1, 1, 1, -1, 1, 0, 0};
-    int dC[] = {-1, 1, -1, 1, 0, 0, -1, 1};
-    int startDir = (p.type == BISHOP) ? 0 : (p.type == ROOK) ? 4
-                                                             : 0;
-    int endDir = (p.type == BISHOP) ? 4 : (p.type == ROOK) ? 8
-                                                           : 8;
-
-    for (int i = startDir; i < endDir; i++)
+    for (int color = WHITE; color <= BLACK; color++)
     {
-        for (int k = 1; k < 8; k++)
+        int sign = (color == WHITE) ? 1 : -1;
+        for (int type = KNIGHT; type <= QUEEN; type++)
         {
-            int newR = r + dR[i] * k;
-            int newC = c + dC[i] * k;
-            if (newR < 0 || newR >= 8 || newC < 0 || newC >= 8)
-                break;
-            if (board->squares[newR][newC].type == EMPTY)
-                count++;
-            else if (board->squares[newR][newC].color != p.color)
+            Bitboard pieces = board->pieceBB[color][type];
+            while (pieces)
             {
-                count++;
-                break;
+                Bitboard attacks = pieceAttacks((PieceType)type, popLsb(&pieces), board->occupiedBB);
+                ei->attacks[color][type] |= attacks;
+                ei->attackedBy[color] |= attacks;
+
+                // Mobility: pseudo-legal destination count
+                int mobility = popCount(attacks & ei->mobilityArea[color]);
+                *mgScore += sign * mobility * MOBILITY_MG;
+                *egScore += sign * mobility * MOBILITY_EG;
             }
-            else
-                break;
         }
     }
-    return count;
 }
 
-static int countKnightMoves(BoardState *board, int r, int c, Piece p)
+// --- Incremental Terms ---
+
+void initEval(void)
 {
-    int count = 0;
-    int dR[] = {-2, -2, -1, -1, 1, 1, 2, 2};
-    int dC[] = {-1, 1, -2, 2, -2, 2, -1, 1};
-    for (int i = 0; i < 8; i++)
+    for (int type = PAWN; type <= KING; type++)
     {
-        int newR = r + dR[i];
-        int newC = c + dC[i];
-        if (newR >= 0 && newR < 8 && newC >= 0 && newC < 8)
+        for (int sq = 0; sq < 64; sq++)
         {
-            if (board->squares[newR][newC].color != p.color)
-                count++;
+            int r = SQ_ROW(sq), c = SQ_COL(sq);
+            psqtMg[WHITE][type][sq] = mg_value[type] + getTableScore(mgTables[type], r, c, WHITE);
+            psqtEg[WHITE][type][sq] = eg_value[type] + getTableScore(egTables[type], r, c, WHITE);
+            psqtMg[BLACK][type][sq] = -(mg_value[type] + getTableScore(mgTables[type], r, c, BLACK));
+            psqtEg[BLACK][type][sq] = -(eg_value[type] + getTableScore(egTables[type], r, c, BLACK));
         }
     }
-    return count;
+}
+
+void computeEvalTerms(const BoardState *board, int *mg, int *eg, int *phase)
+{
+    *mg = *eg = *phase = 0;
+    Bitboard occupied = board->occupiedBB;
+    while (occupied)
+    {
+        int sq = popLsb(&occupied);
+        Piece p = board->squares[SQ_ROW(sq)][SQ_COL(sq)];
+        *mg += psqtMg[p.color][p.type][sq];
+        *eg += psqtEg[p.color][p.type][sq];
+        *phase += phaseWeight[p.type];
+    }
 }
 
 // --- Main Evaluation ---
 
 int evaluateBoard(BoardState *board)
 {
-    int mgScore = 0;
-    int egScore = 0;
-    int gamePhase = 0;
+    // With a network loaded it replaces the terms below (it needs both kings)
+    if (nnueActive && board->kingSq[WHITE] >= 0 && board->kingSq[BLACK] >= 0)
+        return nnueEvaluate(board);
 
-    // 1. Iterate Board
-    for (int r = 0; r < 8; r++)
-    {
-        for (int c = 0; c < 8; c++)
-        {
-            Piece p = board->squares[r][c];
-            if (p.type != EMPTY)
-            {
-                // A. Update Game Phase
-                // We only count major pieces for phase calculation
-                switch (p.type)
-                {
-                case KNIGHT:
-                    gamePhase += 1;
-                    break;
-                case BISHOP:
-                    gamePhase += 1;
-                    break;
-                case ROOK:
-                    gamePhase += 2;
-                    break;
-                case QUEEN:
-                    gamePhase += 4;
-                    break;
-                default:
-                    break;
-                }
-
-                // B. Calculate Material & Mobility
-                int m_val = 0, e_val = 0;
-                m_val = mg_value[p.type];
-                e_val = eg_value[p.type];
-
-                // Positional Scores (PST)
-                switch (p.type)
-                {
-                case PAWN:
-                    m_val += getTableScore(pawn_mg, r, c, p.color);
-                    e_val += getTableScore(pawn_eg, r, c, p.color);
-                    break;
-                case KNIGHT:
-                    m_val += getTableScore(knight_mg, r, c, p.color);
-                    e_val += getTableScore(knight_eg, r, c, p.color);
-                    m_val += countKnightMoves(board, r, c, p) * MOBILITY_MG;
-                    e_val += countKnightMoves(board, r, c, p) * MOBILITY_EG;
-                    break;
-                case BISHOP:
-                    m_val += getTableScore(bishop_mg, r, c, p.color);
-                    e_val += getTableScore(bishop_eg, r, c, p.color);
-                    m_val += countSlidingMoves(board, r, c, p) * MOBILITY_MG;
-                    e_val += countSlidingMoves(board, r, c, p) * MOBILITY_EG;
-                    break;
-                case ROOK:
-                    m_val += getTableScore(rook_mg, r, c, p.color);
-                    e_val += getTableScore(rook_eg, r, c, p.color);
-                    m_val += countSlidingMoves(board, r, c, p) * MOBILITY_MG;
-                    e_val += countSlidingMoves(board, r, c, p) * MOBILITY_EG;
-                    break;
-                case QUEEN:
-                    m_val += getTableScore(queen_mg, r, c, p.color);
-                    e_val += getTableScore(queen_eg, r, c, p.color);
-                    m_val += countSlidingMoves(board, r, c, p) * MOBILITY_MG;
-                    e_val += countSlidingMoves(board, r, c, p) * MOBILITY_EG;
-                    break;
-                case KING:
-                    m_val += getTableScore(king_mg, r, c, p.color);
-                    e_val += getTableScore(king_eg, r, c, p.color);
-                    break;
-                default:
-                    break;
-                }
-
-                // C. Add to Totals
-                if (p.color == WHITE)
-                {
-                    mgScore += m_val;
-                    egScore += e_val;
-                }
-                else
-                {
-                    mgScore -= m_val;
-                    egScore -= e_val;
-                }
-            }
-        }
-    }
+    // 1. Material, PST and phase: maintained incrementally by makeMove/undoMove
+    int mgScore = board->psqMg;
+    int egScore = board->psqEg;
+    int gamePhase = board->phase;
 
-    // 2. Tapered Evaluation Formula
+#ifdef DEBUG
+    // Debug builds verify the running sums against a full recompute
+    int mgCheck, egCheck, phaseCheck;
+    computeEvalTerms(board, &mgCheck, &egCheck, &phaseCheck);
+    assert(mgCheck == mgScore && egCheck == egScore && phaseCheck == gamePhase);
+#endif
+
+    // 2. Attack maps and mobility (knights, bishops, rooks and queens)
+    EvalInfo ei;
+    initEvalInfo(board, &ei);
+    evaluatePieces(board, &ei, &mgScore, &egScore);
+
+    // 3. Pawn structure (cached by pawn key)
+    PawnEntry pawns;
+    probePawns(board, &pawns);
+    mgScore += pawns.mg;
+    egScore += pawns.eg;
+
+    // 4. Tapered Evaluation Formula
     // Cap gamePhase at 24
     if (gamePhase > PHASE_TOTAL)
         gamePhase = PHASE_TOTAL;
@@ -336,4 +329,4 @@ int evaluateBoard(BoardState *board)
 
     // Final Score = (MG_Score * Phase + EG_Score * (24 - Phase)) / 24
     return ((mgScore * mgWeight) + (egScore * egWeight)) / PHASE_TOTAL;
-}
\ No newline at end of file
+}
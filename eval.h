@@ -3,13 +3,35 @@
 
 #include "structs.h" // From Person 1
 
+/*
+ * Material and piece-square values per (color, piece, square), signed from
+ * White's point of view, and the phase weight of each piece type. makeMove
+ * adds and subtracts these as pieces come and go, so BoardState always holds
+ * the static part of the evaluation.
+ */
+extern int psqtMg[2][7][64];
+extern int psqtEg[2][7][64];
+extern const int phaseWeight[7];
+
+/**
+ * @brief Builds the combined material/PST tables. Safe to call more than once.
+ * Must run before any board is loaded.
+ */
+void initEval(void);
+
+/**
+ * @brief Full recomputation of BoardState's psqMg/psqEg/phase (used on load and for verification).
+ */
+void computeEvalTerms(const BoardState *board, int *mg, int *eg, int *phase);
+
 /**
  * @brief Evaluates the current board state and returns a static score.
  *
  * The score is calculated from White's perspective.
  * A positive score favors WHITE.
  * A negative score favors BLACK.
- * The score is based on material and piece-square tables.
+ * The score is based on material, piece-square tables, mobility and pawn structure,
+ * or comes from the NNUE network when one is loaded (see nnue.h).
  *
  * @param board The current board state to evaluate.
  * @return The static evaluation score (int).
@@ -1,9 +1,18 @@
+// mmap() is POSIX, not ISO C
+#define _POSIX_C_SOURCE 200809L
+
 #include "fileio.h"
+#include "game.h"
 #include <stdio.h>
 #include <ctype.h>
 #include <string.h>
 #include <stdlib.h>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define FILEIO_HAVE_MMAP 1
+#endif
+
 // -------------------- Helpers --------------------
 
 char pieceToChar(Piece p)
@@ -106,6 +115,19 @@ static void posToAlgebraic(Position pos, char out[3])
     out[2] = '\0';
 }
 
+void moveToString(Move m, char *out)
+{
+    char promo[] = {0, 0, 'n', 'b', 'r', 'q', 0}; // Indexed by PieceType
+    int n = 0;
+    out[n++] = (char)('a' + SQ_COL(m.from));
+    out[n++] = (char)('8' - SQ_ROW(m.from));
+    out[n++] = (char)('a' + SQ_COL(m.to));
+    out[n++] = (char)('8' - SQ_ROW(m.to));
+    if (m.flag == MOVE_PROMOTION && promo[m.promotion])
+        out[n++] = promo[m.promotion];
+    out[n] = '\0';
+}
+
 // -------------------- Load Board --------------------
 
 bool loadBoardFromFile(const char *filename, BoardState *board)
@@ -202,9 +224,174 @@ bool loadBoardFromFile(const char *filename, BoardState *board)
     board->fullmoveNumber = atoi(line);
 
     fclose(f);
+
+    refreshBoardState(board);
     return true;
 }
 
+// -------------------- Load FEN --------------------
+
+const char *const checkFENs[CHECK_FEN_COUNT] = {
+    START_FEN,
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", // Castling, pins
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",                           // En passant
+    "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",                              // Promotions
+};
+
+// Skip spaces; returns pointer to the next field (or the terminating '\0')
+static const char *nextField(const char *s)
+{
+    while (*s && *s != ' ')
+        s++;
+    while (*s == ' ')
+        s++;
+    return s;
+}
+
+bool loadBoardFromFEN(const char *fen, BoardState *board)
+{
+    BoardState parsed;
+    const char *s = fen;
+
+    while (*s == ' ')
+        s++;
+
+    // --- Piece placement (rank 8 first, matching row 0) ---
+    int r = 0, c = 0;
+    for (; *s && *s != ' '; s++)
+    {
+        if (*s == '/')
+        {
+            if (c != 8)
+                return false;
+            r++;
+            c = 0;
+        }
+        else if (*s >= '1' && *s <= '8')
+        {
+            for (int n = *s - '0'; n > 0; n--)
+            {
+                if (r > 7 || c > 7)
+                    return false;
+                parsed.squares[r][c++] = (Piece){EMPTY, NO_COLOR};
+            }
+        }
+        else
+        {
+            Piece p = charToPiece(*s);
+            if (p.type == EMPTY || r > 7 || c > 7)
+                return false;
+            parsed.squares[r][c++] = p;
+        }
+    }
+    if (r != 7 || c != 8)
+        return false;
+
+    // --- Side to move ---
+    s = nextField(s);
+    if (*s != 'w' && *s != 'b')
+        return false;
+    parsed.currentPlayer = (*s == 'w') ? WHITE : BLACK;
+
+    // --- Castling rights ---
+    s = nextField(s);
+    parsed.castling = (CastlingRights){0, 0, 0, 0};
+    for (; *s && *s != ' '; s++)
+    {
+        switch (*s)
+        {
+        case 'K':
+            parsed.castling.wk = 1;
+            break;
+        case 'Q':
+            parsed.castling.wq = 1;
+            break;
+        case 'k':
+            parsed.castling.bk = 1;
+            break;
+        case 'q':
+            parsed.castling.bq = 1;
+            break;
+        case '-':
+            break;
+        default:
+            return false;
+        }
+    }
+
+    // --- En passant target ---
+    s = nextField(s);
+    parsed.enPassantTarget = (Position){-1, -1};
+    if (*s && *s != '-')
+    {
+        char square[3] = {s[0], s[1], '\0'};
+        parsed.enPassantTarget = algebraicToPos(square);
+        if (parsed.enPassantTarget.row == -1)
+            return false;
+    }
+
+    // --- Clocks (optional) ---
+    s = nextField(s);
+    parsed.halfmoveClock = (*s >= '0' && *s <= '9') ? atoi(s) : 0;
+    s = nextField(s);
+    parsed.fullmoveNumber = (*s >= '0' && *s <= '9') ? atoi(s) : 1;
+
+    refreshBoardState(&parsed);
+    *board = parsed;
+    return true;
+}
+
+void boardToFEN(const BoardState *board, char *out)
+{
+    int n = 0;
+
+    // --- Piece placement (row 0 is rank 8) ---
+    for (int r = 0; r < 8; r++)
+    {
+        int empty = 0;
+        for (int c = 0; c < 8; c++)
+        {
+            Piece p = board->squares[r][c];
+            if (p.type == EMPTY)
+            {
+                empty++;
+                continue;
+            }
+            if (empty)
+                out[n++] = (char)('0' + empty);
+            empty = 0;
+            out[n++] = pieceToChar(p);
+        }
+        if (empty)
+            out[n++] = (char)('0' + empty);
+        if (r < 7)
+            out[n++] = '/';
+    }
+
+    // --- Side to move ---
+    out[n++] = ' ';
+    out[n++] = (board->currentPlayer == WHITE) ? 'w' : 'b';
+
+    // --- Castling rights ---
+    out[n++] = ' ';
+    int castlingStart = n;
+    if (board->castling.wk)
+        out[n++] = 'K';
+    if (board->castling.wq)
+        out[n++] = 'Q';
+    if (board->castling.bk)
+        out[n++] = 'k';
+    if (board->castling.bq)
+        out[n++] = 'q';
+    if (n == castlingStart)
+        out[n++] = '-';
+
+    // --- En passant target and clocks ---
+    char ep[3];
+    posToAlgebraic(board->enPassantTarget, ep);
+    snprintf(out + n, (size_t)(FEN_MAX_LENGTH - n), " %s %d %d", ep, board->halfmoveClock, board->fullmoveNumber);
+}
+
 // -------------------- Save Board --------------------
 
 bool saveBoardToFile(const char *filename, const BoardState *board)
@@ -254,3 +441,55 @@ bool saveBoardToFile(const char *filename, const BoardState *board)
     fclose(f);
     return true;
 }
+
+// -------------------- Mapped Files --------------------
+
+bool mapFile(const char *path, MappedFile *file)
+{
+    *file = (MappedFile){NULL, 0, false};
+
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return false;
+    long length = (fseek(f, 0, SEEK_END) == 0) ? ftell(f) : -1;
+    if (length <= 0)
+    {
+        fclose(f);
+        return length == 0; // Nothing to map
+    }
+    size_t size = (size_t)length;
+
+#ifdef FILEIO_HAVE_MMAP
+    void *data = mmap(NULL, size, PROT_READ, MAP_SHARED, fileno(f), 0);
+    if (data != MAP_FAILED)
+    {
+        fclose(f); // The mapping stays valid without the descriptor
+        *file = (MappedFile){data, size, true};
+        return true;
+    }
+#endif
+
+    uint8_t *buffer = malloc(size);
+    bool ok = buffer && fseek(f, 0, SEEK_SET) == 0 && fread(buffer, 1, size, f) == size;
+    fclose(f);
+    if (!ok)
+    {
+        free(buffer);
+        return false;
+    }
+    *file = (MappedFile){buffer, size, false};
+    return true;
+}
+
+void unmapFile(MappedFile *file)
+{
+    if (!file->data)
+        return;
+#ifdef FILEIO_HAVE_MMAP
+    if (file->mapped)
+        munmap((void *)file->data, file->size);
+    else
+#endif
+        free((void *)file->data);
+    *file = (MappedFile){NULL, 0, false};
+}
@@ -3,6 +3,8 @@
 
 #include "structs.h"
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 // Load board from a text file (simple 8x8 layout)
 bool loadBoardFromFile(const char *filename, BoardState *board);
@@ -10,10 +12,41 @@ bool loadBoardFromFile(const char *filename, BoardState *board);
 // Save board to text file
 bool saveBoardToFile(const char *filename, const BoardState *board);
 
+#define START_FEN "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+
+// Start points of the self checks' random games: castling, pins, en passant, promotions
+#define CHECK_FEN_COUNT 4
+extern const char *const checkFENs[CHECK_FEN_COUNT];
+
+// Load board from a FEN string; the move clocks may be omitted (EPD style)
+bool loadBoardFromFEN(const char *fen, BoardState *board);
+
+#define FEN_MAX_LENGTH 96 // Longest FEN boardToFEN() writes, terminator included
+
+// Write the position as a FEN string; 'out' needs FEN_MAX_LENGTH chars
+void boardToFEN(const BoardState *board, char *out);
+
 // Convert a piece to character (uppercase = white, lowercase = black)
 char pieceToChar(Piece p);
 
 // Convert character from file to piece
 Piece charToPiece(char c);
 
+// Write a move in long algebraic notation ("e2e4", "a7a8q"); 'out' needs 6 chars
+void moveToString(Move m, char *out);
+
+// A whole file in memory, read-only: mapped where mmap() is available, else read in
+typedef struct
+{
+    const uint8_t *data;
+    size_t size;
+    bool mapped; // Mapped (munmap) or read into memory (free)
+} MappedFile;
+
+// Map or read all of 'path'; an empty file succeeds with data == NULL
+bool mapFile(const char *path, MappedFile *file);
+
+// Release what mapFile() returned; safe on an empty or already released file
+void unmapFile(MappedFile *file);
+
 #endif
@@ -1,76 +1,101 @@
 #include "game.h"
+#include "attacks.h"
+#include "eval.h"
+#include "zobrist.h"
+#include "nnue.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 /*
  * Implementation notes / invariants:
- * - This file keeps an internal history stack to allow undoMove() to restore
- * previous board state. The history only stores what we need: captured piece,
- * castling rights, enPassantTarget, halfmove clock and fullmove number and the move flag.
+ * - makeMove() fills a caller-owned MoveRecord and undoMove() restores the board from
+ * it, so this file holds no state and any number of boards can be searched at once.
+ * The record only stores what we need: captured piece, castling rights, enPassantTarget,
+ * halfmove clock and fullmove number and the move flag, plus the previous Zobrist key
+ * so undo restores it without recomputation. Records must be undone in LIFO order.
  *
  * - The layout of BoardState/squares/currentPlayer/castling/enPassantTarget/halfmoveClock
  * must match the assumptions stated above.
+ *
+ * - squares[][] and the bitboards describe the same position at all times. Make/undo
+ * only touch the board through putPiece/removePiece/movePiece; anything that writes
+ * squares[][] directly (file loading, setup) must call refreshBoardState() afterwards.
+ * The same holds for kingSq[], which lets check detection skip any king search,
+ * and for the evaluation accumulators psqMg/psqEg/phase and, while a network is
+ * loaded, the NNUE accumulator.
  */
 
-/* ---------- Internal helper types ---------- */
+/* ---------- Helper functions ---------- */
 
-typedef struct
+static bool onBoard(int r, int c)
 {
-    Move move;
-    Piece captured;
-    CastlingRights prevCastling;
-    Position prevEnPassant;
-    int prevHalfmoveClock;
-    int prevFullmoveNumber;
-    PieceColor prevPlayer;
-} MoveRecord;
-
-#define MAX_HISTORY 4096
-static MoveRecord historyStack[MAX_HISTORY];
-static int historyTop = 0;
-
-/* ---------- Helper functions ---------- */
+    return (r >= 0 && r < 8 && c >= 0 && c < 8);
+}
 
-static void pushHistory(MoveRecord rec)
+/* Find king position for a color */
+static Position findKing(BoardState *board, PieceColor color)
 {
-    if (historyTop < MAX_HISTORY)
-    {
-        historyStack[historyTop++] = rec;
-    }
-    else
-    {
-        // overflow — in practice shouldn't happen; but drop oldest (not ideal)
-        // For safety, cap
-        historyTop = MAX_HISTORY - 1;
-        historyStack[historyTop] = rec;
-    }
+    int sq = board->kingSq[color];
+    if (sq < 0)
+        return (Position){-1, -1};
+    return (Position){SQ_ROW(sq), SQ_COL(sq)};
 }
 
-static MoveRecord popHistory(void)
+/*
+ * Board mutation primitives. Every change to squares[][] during make/undo goes
+ * through these so the bitboards never drift from the mailbox.
+ */
+
+/* Place a piece on an empty square */
+static void putPiece(BoardState *board, int r, int c, Piece p)
 {
-    MoveRecord empty = {0};
-    if (historyTop <= 0)
-        return empty;
-    return historyStack[--historyTop];
+    Bitboard b = BIT(SQ(r, c));
+    board->squares[r][c] = p;
+    board->hash ^= zobristPieces[p.color][p.type][SQ(r, c)];
+    board->psqMg += psqtMg[p.color][p.type][SQ(r, c)];
+    board->psqEg += psqtEg[p.color][p.type][SQ(r, c)];
+    board->phase += phaseWeight[p.type];
+    board->pieceBB[p.color][p.type] |= b;
+    board->colorBB[p.color] |= b;
+    board->occupiedBB |= b;
+    if (p.type == PAWN)
+        board->pawnKey ^= zobristPieces[p.color][PAWN][SQ(r, c)];
+    if (p.type == KING)
+        board->kingSq[p.color] = SQ(r, c);
+    else if (nnueActive)
+        nnueAddPiece(board, p, SQ(r, c));
 }
 
-static bool onBoard(int r, int c)
+/* Clear a square, returning whatever stood there (possibly EMPTY) */
+static Piece removePiece(BoardState *board, int r, int c)
 {
-    return (r >= 0 && r < 8 && c >= 0 && c < 8);
+    Piece p = board->squares[r][c];
+    if (p.type == EMPTY)
+        return p;
+
+    Bitboard b = BIT(SQ(r, c));
+    board->pieceBB[p.color][p.type] &= ~b;
+    board->colorBB[p.color] &= ~b;
+    board->occupiedBB &= ~b;
+    board->squares[r][c] = (Piece){EMPTY, NO_COLOR};
+    board->hash ^= zobristPieces[p.color][p.type][SQ(r, c)];
+    board->psqMg -= psqtMg[p.color][p.type][SQ(r, c)];
+    board->psqEg -= psqtEg[p.color][p.type][SQ(r, c)];
+    board->phase -= phaseWeight[p.type];
+    if (p.type == PAWN)
+        board->pawnKey ^= zobristPieces[p.color][PAWN][SQ(r, c)];
+    if (p.type == KING)
+        board->kingSq[p.color] = -1;
+    else if (nnueActive)
+        nnueRemovePiece(board, p, SQ(r, c));
+    return p;
 }
 
-/* Find king position for a color */
-static Position findKing(BoardState *board, PieceColor color)
+/* Move a piece to an empty square */
+static void movePiece(BoardState *board, int fromR, int fromC, int toR, int toC)
 {
-    for (int r = 0; r < 8; r++)
-        for (int c = 0; c < 8; c++)
-        {
-            Piece p = board->squares[r][c];
-            if (p.type == KING && p.color == color)
-                return (Position){r, c};
-        }
-    return (Position){-1, -1};
+    putPiece(board, toR, toC, removePiece(board, fromR, fromC));
 }
 
 /* Helper to clear enPassantTarget */
@@ -82,21 +107,57 @@ static void clearEnPassant(BoardState *board)
 
 /* ---------- Public API implementations ---------- */
 
-void makeMove(BoardState *board, Move move)
+void refreshBoardState(BoardState *board)
+{
+    memset(board->pieceBB, 0, sizeof(board->pieceBB));
+    memset(board->colorBB, 0, sizeof(board->colorBB));
+    board->occupiedBB = 0;
+
+    for (int r = 0; r < 8; r++)
+        for (int c = 0; c < 8; c++)
+        {
+            Piece p = board->squares[r][c];
+            if (p.type == EMPTY)
+                continue;
+            Bitboard b = BIT(SQ(r, c));
+            board->pieceBB[p.color][p.type] |= b;
+            board->colorBB[p.color] |= b;
+            board->occupiedBB |= b;
+        }
+
+    // With several kings of one color (broken setups) the lowest square wins
+    for (int color = WHITE; color <= BLACK; color++)
+        board->kingSq[color] = board->pieceBB[color][KING] ? lsb(board->pieceBB[color][KING]) : -1;
+
+    board->hash = computeHash(board);
+    board->pawnKey = computePawnKey(board);
+    computeEvalTerms(board, &board->psqMg, &board->psqEg, &board->phase);
+    nnueReset(board);
+    board->historyLength = 0; // A new position has no past
+}
+
+void makeMove(BoardState *board, Move move, MoveRecord *rec)
 {
     // Save previous state into record
-    MoveRecord rec;
-    rec.move = move;
-    rec.prevCastling = board->castling;
-    rec.prevEnPassant = board->enPassantTarget;
-    rec.prevHalfmoveClock = board->halfmoveClock;
-    rec.prevFullmoveNumber = board->fullmoveNumber;
-    rec.prevPlayer = board->currentPlayer;
-
-    Position from = move.from;
-    Position to = move.to;
+    rec->move = move;
+    rec->prevCastling = board->castling;
+    rec->prevEnPassant = board->enPassantTarget;
+    rec->prevHalfmoveClock = board->halfmoveClock;
+    rec->prevFullmoveNumber = board->fullmoveNumber;
+    rec->prevPlayer = board->currentPlayer;
+    rec->prevHash = board->hash;
+    board->keyHistory[board->historyLength++ & (KEY_HISTORY_SIZE - 1)] = board->hash;
+
+    // Take the old castling / en passant state out of the key; the new state is
+    // hashed back in once the move has been applied.
+    board->hash ^= zobristCastling[castlingIndex(board->castling)];
+    if (board->enPassantTarget.row != -1)
+        board->hash ^= zobristEnPassant[board->enPassantTarget.col];
+
+    Position from = {SQ_ROW(move.from), SQ_COL(move.from)};
+    Position to = {SQ_ROW(move.to), SQ_COL(move.to)};
     Piece moving = board->squares[from.row][from.col];
-    rec.captured = board->squares[to.row][to.col]; // may be EMPTY
+    rec->captured = board->squares[to.row][to.col]; // may be EMPTY
 
     // Default: increment halfmove clock when no capture and no pawn move
     bool resetHalfmove = false;
@@ -105,8 +166,7 @@ void makeMove(BoardState *board, Move move)
     if (move.flag == MOVE_CASTLE_KING || move.flag == MOVE_CASTLE_QUEEN)
     {
         // move king
-        board->squares[to.row][to.col] = moving;
-        board->squares[from.row][from.col] = (Piece){EMPTY, NO_COLOR};
+        movePiece(board, from.row, from.col, to.row, to.col);
 
         // Move the rook accordingly
         if (moving.color == WHITE)
@@ -114,14 +174,12 @@ void makeMove(BoardState *board, Move move)
             if (move.flag == MOVE_CASTLE_KING)
             {
                 // White king e1->g1, rook h1->f1
-                board->squares[7][5] = board->squares[7][7];
-                board->squares[7][7] = (Piece){EMPTY, NO_COLOR};
+                movePiece(board, 7, 7, 7, 5);
             }
             else
             {
                 // queenside: e1->c1, rook a1->d1
-                board->squares[7][3] = board->squares[7][0];
-                board->squares[7][0] = (Piece){EMPTY, NO_COLOR};
+                movePiece(board, 7, 0, 7, 3);
             }
             board->castling.wk = board->castling.wq = 0;
         }
@@ -130,14 +188,12 @@ void makeMove(BoardState *board, Move move)
             if (move.flag == MOVE_CASTLE_KING)
             {
                 // Black e8->g8, rook h8->f8
-                board->squares[0][5] = board->squares[0][7];
-                board->squares[0][7] = (Piece){EMPTY, NO_COLOR};
+                movePiece(board, 0, 7, 0, 5);
             }
             else
             {
                 // Black queenside
-                board->squares[0][3] = board->squares[0][0];
-                board->squares[0][0] = (Piece){EMPTY, NO_COLOR};
+                movePiece(board, 0, 0, 0, 3);
             }
             board->castling.bk = board->castling.bq = 0;
         }
@@ -149,15 +205,13 @@ void makeMove(BoardState *board, Move move)
     else if (move.flag == MOVE_EN_PASSANT)
     {
         // Normal move of pawn to capture en-passant target square
-        board->squares[to.row][to.col] = moving;
-        board->squares[from.row][from.col] = (Piece){EMPTY, NO_COLOR};
+        movePiece(board, from.row, from.col, to.row, to.col);
 
         // Remove the captured pawn which is behind the to-square
-        int capRow = rec.prevPlayer == WHITE ? to.row + 1 : to.row - 1;
+        int capRow = rec->prevPlayer == WHITE ? to.row + 1 : to.row - 1;
         if (onBoard(capRow, to.col))
         {
-            rec.captured = board->squares[capRow][to.col];
-            board->squares[capRow][to.col] = (Piece){EMPTY, NO_COLOR};
+            rec->captured = removePiece(board, capRow, to.col);
         }
         clearEnPassant(board);
         resetHalfmove = true; // pawn capture resets halfmove clock
@@ -169,20 +223,21 @@ void makeMove(BoardState *board, Move move)
         if (move.flag == MOVE_PROMOTION && (moving.type == PAWN))
         {
             Piece promoted = {move.promotion, moving.color};
-            board->squares[to.row][to.col] = promoted;
-            board->squares[from.row][from.col] = (Piece){EMPTY, NO_COLOR};
+            removePiece(board, to.row, to.col);
+            removePiece(board, from.row, from.col);
+            putPiece(board, to.row, to.col, promoted);
             // Promotion resets halfmove clock
             resetHalfmove = true;
         }
         else
         {
             // Normal move
-            // Copy moving piece to destination (overwriting captured)
-            board->squares[to.row][to.col] = moving;
-            board->squares[from.row][from.col] = (Piece){EMPTY, NO_COLOR};
+            // Lift the captured piece (if any), then move onto the square
+            removePiece(board, to.row, to.col);
+            movePiece(board, from.row, from.col, to.row, to.col);
 
             // If capture occurred set resetHalfmove
-            if (rec.captured.type != EMPTY)
+            if (rec->captured.type != EMPTY)
                 resetHalfmove = true;
         }
 
@@ -206,9 +261,9 @@ void makeMove(BoardState *board, Move move)
     // 2) Update castling rights when rooks/king move or when rook is captured on original squares
     // Removing rights if a rook is captured on starting square:
     // Check capture of white rook at a1/h1 or black rook at a8/h8
-    if (rec.captured.type == ROOK)
+    if (rec->captured.type == ROOK)
     {
-        if (rec.captured.color == WHITE)
+        if (rec->captured.color == WHITE)
         {
             if (to.row == 7 && to.col == 0)
                 board->castling.wq = 0;
@@ -271,84 +326,70 @@ void makeMove(BoardState *board, Move move)
     // 4) Switch player
     board->currentPlayer = (board->currentPlayer == WHITE) ? BLACK : WHITE;
 
-    // 5) Push history record
-    pushHistory(rec);
+    // Complete the incremental key update
+    board->hash ^= zobristCastling[castlingIndex(board->castling)];
+    if (board->enPassantTarget.row != -1)
+        board->hash ^= zobristEnPassant[board->enPassantTarget.col];
+    board->hash ^= zobristSide;
 }
 
-void undoMove(BoardState *board, Move move)
+void undoMove(BoardState *board, const MoveRecord *rec)
 {
-    // Pop history
-    if (historyTop <= 0)
-    {
-        // Nothing to undo
-        return;
-    }
-    MoveRecord rec = popHistory();
-
-    Position from = rec.move.from;
-    Position to = rec.move.to;
-    Piece movedPiece; // we need to find what piece is currently on 'to' (or special handling)
 
+    Position from = {SQ_ROW(rec->move.from), SQ_COL(rec->move.from)};
+    Position to = {SQ_ROW(rec->move.to), SQ_COL(rec->move.to)};
     // Switch player back first (since makeMove switched it)
-    board->currentPlayer = rec.prevPlayer;
+    board->currentPlayer = rec->prevPlayer;
 
     // Restore fullmove and halfmove
-    board->halfmoveClock = rec.prevHalfmoveClock;
-    board->fullmoveNumber = rec.prevFullmoveNumber;
-    board->castling = rec.prevCastling;
-    board->enPassantTarget = rec.prevEnPassant;
+    board->halfmoveClock = rec->prevHalfmoveClock;
+    board->fullmoveNumber = rec->prevFullmoveNumber;
+    board->castling = rec->prevCastling;
+    board->enPassantTarget = rec->prevEnPassant;
 
     // Handle special move undo
-    if (rec.move.flag == MOVE_CASTLE_KING || rec.move.flag == MOVE_CASTLE_QUEEN)
+    if (rec->move.flag == MOVE_CASTLE_KING || rec->move.flag == MOVE_CASTLE_QUEEN)
     {
         // King should be at 'to' and rook at f1/d1 or f8/d8; restore original positions
-        movedPiece = board->squares[to.row][to.col];
         // Move king back
-        board->squares[from.row][from.col] = movedPiece;
-        board->squares[to.row][to.col] = (Piece){EMPTY, NO_COLOR};
+        movePiece(board, to.row, to.col, from.row, from.col);
 
         // Restore rook
-        if (rec.prevPlayer == WHITE)
+        if (rec->prevPlayer == WHITE)
         {
-            if (rec.move.flag == MOVE_CASTLE_KING)
+            if (rec->move.flag == MOVE_CASTLE_KING)
             {
                 // rook f1 -> h1
-                board->squares[7][7] = board->squares[7][5];
-                board->squares[7][5] = (Piece){EMPTY, NO_COLOR};
+                movePiece(board, 7, 5, 7, 7);
             }
             else
             {
                 // rook d1 -> a1
-                board->squares[7][0] = board->squares[7][3];
-                board->squares[7][3] = (Piece){EMPTY, NO_COLOR};
+                movePiece(board, 7, 3, 7, 0);
             }
         }
         else
         {
-            if (rec.move.flag == MOVE_CASTLE_KING)
+            if (rec->move.flag == MOVE_CASTLE_KING)
             {
-                board->squares[0][7] = board->squares[0][5];
-                board->squares[0][5] = (Piece){EMPTY, NO_COLOR};
+                movePiece(board, 0, 5, 0, 7);
             }
             else
             {
-                board->squares[0][0] = board->squares[0][3];
-                board->squares[0][3] = (Piece){EMPTY, NO_COLOR};
+                movePiece(board, 0, 3, 0, 0);
             }
         }
     }
-    else if (rec.move.flag == MOVE_EN_PASSANT)
+    else if (rec->move.flag == MOVE_EN_PASSANT)
     {
-        // The pawn moved to 'to' and captured pawn is behind it (in rec.captured)
-        movedPiece = board->squares[to.row][to.col];
+        // The pawn moved to 'to' and captured pawn is behind it (in rec->captured)
         // Move pawn back
-        board->squares[from.row][from.col] = movedPiece;
-        board->squares[to.row][to.col] = (Piece){EMPTY, NO_COLOR};
+        movePiece(board, to.row, to.col, from.row, from.col);
         // Restore captured pawn
-        int capRow = (rec.prevPlayer == WHITE) ? to.row + 1 : to.row - 1;
-        if (onBoard(capRow, to.col))
+        int capRow = (rec->prevPlayer == WHITE) ? to.row + 1 : to.row - 1;
+        if (onBoard(capRow, to.col) && rec->captured.type != EMPTY)
         {
-            board->squares[capRow][to.col] = rec.captured;
+            putPiece(board, capRow, to.col, rec->captured);
         }
     }
     else
@@ -356,100 +397,89 @@ void undoMove(BoardState *board, Move move)
         // Normal move or promotion
 
         // If promotion happened, current dest holds promoted piece; put pawn back
-        if (rec.move.flag == MOVE_PROMOTION)
+        if (rec->move.flag == MOVE_PROMOTION)
         {
             // Restore pawn
-            Piece pawn = {PAWN, rec.prevPlayer};
-            board->squares[from.row][from.col] = pawn;
-            // Restore captured piece (if any) on destination
-            board->squares[to.row][to.col] = rec.captured;
+            Piece pawn = {PAWN, rec->prevPlayer};
+            removePiece(board, to.row, to.col);
+            putPiece(board, from.row, from.col, pawn);
         }
         else
         {
-            // Normal move: move piece back and restore captured
-            board->squares[from.row][from.col] = board->squares[to.row][to.col];
-            board->squares[to.row][to.col] = rec.captured;
+            // Normal move: move piece back
+            movePiece(board, to.row, to.col, from.row, from.col);
         }
+
+        // Restore captured piece (if any) on destination
+        if (rec->captured.type != EMPTY)
+            putPiece(board, to.row, to.col, rec->captured);
     }
+
+    // The piece helpers above XORed keys as they went; the saved key is authoritative
+    board->hash = rec->prevHash;
+    board->historyLength--;
 }
 
-bool isSquareAttacked(BoardState *board, int r, int c, PieceColor attackerColor)
+void makeNullMove(BoardState *board, MoveRecord *rec)
 {
-    // Sliding pieces (rook, bishop, queen)
-    int dR[] = {-1, -1, 1, 1, -1, 1, 0, 0};
-    int dC[] = {-1, 1, -1, 1, 0, 0, -1, 1};
-    for (int i = 0; i < 8; i++)
+    rec->move = NO_MOVE;
+    rec->captured = (Piece){EMPTY, WHITE};
+    rec->prevCastling = board->castling;
+    rec->prevEnPassant = board->enPassantTarget;
+    rec->prevHalfmoveClock = board->halfmoveClock;
+    rec->prevFullmoveNumber = board->fullmoveNumber;
+    rec->prevPlayer = board->currentPlayer;
+    rec->prevHash = board->hash;
+    board->keyHistory[board->historyLength++ & (KEY_HISTORY_SIZE - 1)] = board->hash;
+
+    if (board->enPassantTarget.row != -1)
     {
-        for (int k = 1; k < 8; k++)
-        {
-            int nR = r + dR[i] * k;
-            int nC = c + dC[i] * k;
-            if (!onBoard(nR, nC))
-                break;
-            Piece p = board->squares[nR][nC];
-            if (p.type != EMPTY)
-            {
-                if (p.color == attackerColor)
-                {
-                    if (p.type == QUEEN)
-                        return true;
-                    if (i < 4 && p.type == BISHOP)
-                        return true; // diagonal directions 0..3
-                    if (i >= 4 && p.type == ROOK)
-                        return true; // straight directions 4..7
-                }
-                break; // blocked
-            }
-        }
+        board->hash ^= zobristEnPassant[board->enPassantTarget.col];
+        board->enPassantTarget = (Position){-1, -1};
     }
 
-    // Knights
-    int knR[] = {-2, -2, -1, -1, 1, 1, 2, 2};
-    int knC[] = {-1, 1, -2, 2, -2, 2, -1, 1};
-    for (int i = 0; i < 8; i++)
-    {
-        int nR = r + knR[i], nC = c + knC[i];
-        if (!onBoard(nR, nC))
-            continue;
-        Piece p = board->squares[nR][nC];
-        if (p.color == attackerColor && p.type == KNIGHT)
-            return true;
-    }
+    // Counts as irreversible: a line through a null move repeats nothing real
+    board->halfmoveClock = 0;
+    if (board->currentPlayer == BLACK)
+        board->fullmoveNumber++;
 
-    // Pawns (attack squares differ by color)
-    int pawnDir = (attackerColor == WHITE) ? -1 : 1; // attacker white pawns move "up" (row--)
-    // Note: ai.c earlier had a different pawnDir convention; ensure consistency:
-    // Here: if attacker is WHITE, they attack from r+1 (towards smaller row)
-    int pr = r - pawnDir;
-    if (pr >= 0 && pr < 8)
-    {
-        if (c - 1 >= 0)
-        {
-            Piece p = board->squares[pr][c - 1];
-            if (p.color == attackerColor && p.type == PAWN)
-                return true;
-        }
-        if (c + 1 < 8)
-        {
-            Piece p = board->squares[pr][c + 1];
-            if (p.color == attackerColor && p.type == PAWN)
-                return true;
-        }
-    }
+    board->currentPlayer = (board->currentPlayer == WHITE) ? BLACK : WHITE;
+    board->hash ^= zobristSide;
+}
 
-    // King (one-square adjacency)
-    for (int i = -1; i <= 1; i++)
-        for (int j = -1; j <= 1; j++)
-        {
-            if (i == 0 && j == 0)
-                continue;
-            int nR = r + i, nC = c + j;
-            if (!onBoard(nR, nC))
-                continue;
-            Piece p = board->squares[nR][nC];
-            if (p.color == attackerColor && p.type == KING)
-                return true;
-        }
+void undoNullMove(BoardState *board, const MoveRecord *rec)
+{
+    board->currentPlayer = rec->prevPlayer;
+    board->halfmoveClock = rec->prevHalfmoveClock;
+    board->fullmoveNumber = rec->prevFullmoveNumber;
+    board->castling = rec->prevCastling;
+    board->enPassantTarget = rec->prevEnPassant;
+    board->hash = rec->prevHash;
+    board->historyLength--;
+}
+
+bool isSquareAttacked(BoardState *board, int r, int c, PieceColor attackerColor)
+{
+    int sq = SQ(r, c);
+    const Bitboard *attacker = board->pieceBB[attackerColor];
+    PieceColor defender = (attackerColor == WHITE) ? BLACK : WHITE;
+
+    // Leapers: a piece on X attacks sq exactly when the same piece on sq attacks X.
+    // For pawns the direction flips, so look up the defender's pawn pattern.
+    if (pawnAttacks[defender][sq] & attacker[PAWN])
+        return true;
+    if (knightAttacks[sq] & attacker[KNIGHT])
+        return true;
+    if (kingAttacks[sq] & attacker[KING])
+        return true;
+
+    // Sliding pieces (rook, bishop, queen)
+    Bitboard diagonal = attacker[BISHOP] | attacker[QUEEN];
+    if (diagonal && (bishopAttacks(sq, board->occupiedBB) & diagonal))
+        return true;
+    Bitboard straight = attacker[ROOK] | attacker[QUEEN];
+    if (straight && (rookAttacks(sq, board->occupiedBB) & straight))
+        return true;
 
     return false;
 }
@@ -464,4 +494,11 @@ bool isKingInCheck(BoardState *board, PieceColor kingColor)
     }
     PieceColor attacker = (kingColor == WHITE) ? BLACK : WHITE;
     return isSquareAttacked(board, kp.row, kp.col, attacker);
-}
\ No newline at end of file
+}
+
+bool isLegalPosition(BoardState *board)
+{
+    if (popCount(board->pieceBB[WHITE][KING]) != 1 || popCount(board->pieceBB[BLACK][KING]) != 1)
+        return false;
+    return !isKingInCheck(board, (board->currentPlayer == WHITE) ? BLACK : WHITE);
+}
@@ -5,9 +5,23 @@
 #include <stdbool.h>
 
 /* Public functions used by other modules (ai.c, eval.c, etc.) */
-void makeMove(BoardState *board, Move move);
-void undoMove(BoardState *board, Move move);
+
+/* Rebuild bitboards from squares[][] after the mailbox was written directly */
+void refreshBoardState(BoardState *board);
+
+/* Plays 'move' and saves what is needed to take it back into '*record' */
+void makeMove(BoardState *board, Move move, MoveRecord *record);
+/* Takes back the move saved in 'record' (must be the most recent one still applied) */
+void undoMove(BoardState *board, const MoveRecord *record);
+/* Passes the turn without moving (null-move pruning); clears any en passant target and
+ * restarts the halfmove clock, so repetition checks never reach across a null move */
+void makeNullMove(BoardState *board, MoveRecord *record);
+/* Takes back a makeNullMove() */
+void undoNullMove(BoardState *board, const MoveRecord *record);
 bool isKingInCheck(BoardState *board, PieceColor kingColor);
 bool isSquareAttacked(BoardState *board, int r, int c, PieceColor attackerColor);
+/* One king per side and the side that just moved not left in check: what a search needs
+ * beyond a well-formed FEN */
+bool isLegalPosition(BoardState *board);
 
 #endif // GAME_H
@@ -8,6 +8,7 @@
  * 2. Input Parsing: Converts Algebraic Notation ("e2e4") into engine coordinates.
  * 3. Output: Displays the board and game status.
  * 4. Game Over Detection: Checks for Checkmate/Stalemate at the start of every turn.
+ * 5. Front Ends: "uci" (as command or as the first move) switches to the UCI protocol.
  * ======================================================================================
  */
 
@@ -21,7 +22,21 @@
 #include "fileio.h"
 #include "game.h"
 #include "ai.h"
+#include "movegen.h"
 #include "eval.h"
+#include "attacks.h"
+#include "zobrist.h"
+#include "tt.h"
+#include "pawns.h"
+#include "bench.h"
+#include "perft.h"
+#include "timer.h"
+#include "uci.h"
+#include "syzygy.h"
+#include "book.h"
+#include "nnue.h"
+#include "batch.h"
+#include "packed.h"
 
 /* ========================================================================== */
 /* VISUALIZATION HELPERS                                                      */
@@ -55,32 +70,9 @@ void printBoard(BoardState *board)
  */
 void printMove(Move m)
 {
-    // Convert numeric coordinates back to characters
-    // 'a' + column index, '8' - row index
-    printf("%c%d%c%d", 'a' + m.from.col, 8 - m.from.row, 'a' + m.to.col, 8 - m.to.row);
-
-    // If it's a promotion, append the piece character
-    if (m.flag == MOVE_PROMOTION)
-    {
-        switch (m.promotion)
-        {
-        case QUEEN:
-            printf("q");
-            break;
-        case ROOK:
-            printf("r");
-            break;
-        case BISHOP:
-            printf("b");
-            break;
-        case KNIGHT:
-            printf("n");
-            break;
-        default:
-            break;
-        }
-    }
-    printf("\n");
+    char text[6];
+    moveToString(m, text);
+    printf("%s\n", text);
 }
 
 /* ========================================================================== */
@@ -94,23 +86,18 @@ void printMove(Move m)
  */
 Move parseMove(char *s)
 {
-    Move m;
-    m.flag = MOVE_NORMAL;
-    m.promotion = EMPTY;
+    Move m = NO_MOVE;
 
-    // Basic validation: Must be at least 4 chars (e.g., "e2e4")
-    if (strlen(s) < 4)
+    // Basic validation: Must be at least 4 chars (e.g., "e2e4") on the board
+    if (strlen(s) < 4 || s[0] < 'a' || s[0] > 'h' || s[1] < '1' || s[1] > '8' ||
+        s[2] < 'a' || s[2] > 'h' || s[3] < '1' || s[3] > '8')
     {
-        m.from.row = -1; // Marker for invalid input
-        return m;
+        return NO_MOVE; // Marker for invalid input
     }
 
-    // Convert 'a'-'h' to 0-7
-    m.from.col = s[0] - 'a';
-    // Convert '8'-'1' to 0-7 (Note: Row 0 is Rank 8)
-    m.from.row = 8 - (s[1] - '0');
-    m.to.col = s[2] - 'a';
-    m.to.row = 8 - (s[3] - '0');
+    // Convert 'a'-'h' to column 0-7 and '8'-'1' to row 0-7 (Note: Row 0 is Rank 8)
+    m.from = (uint8_t)SQ(8 - (s[1] - '0'), s[0] - 'a');
+    m.to = (uint8_t)SQ(8 - (s[3] - '0'), s[2] - 'a');
 
     // Check for Promotion suffix (5th character)
     if (strlen(s) >= 5)
@@ -150,15 +137,15 @@ Move parseMove(char *s)
  */
 bool resolveMove(BoardState *board, Move inputMove, Move *resolvedMove)
 {
-    MoveList list = generateAllLegalMoves(board);
+    MoveList list;
+    generateAllLegalMoves(board, &list);
 
     for (int i = 0; i < list.count; i++)
     {
         Move m = list.moves[i];
 
         // 1. Check if coordinates match
-        if (m.from.row == inputMove.from.row && m.from.col == inputMove.from.col &&
-            m.to.row == inputMove.to.row && m.to.col == inputMove.to.col)
+        if (m.from == inputMove.from && m.to == inputMove.to)
         {
             // 2. Handling Promotions
             if (m.flag == MOVE_PROMOTION)
@@ -195,31 +182,279 @@ bool resolveMove(BoardState *board, Move inputMove, Move *resolvedMove)
 /* MAIN LOOP                                                                  */
 /* ========================================================================== */
 
-int main()
+/* "selftest": checks of the code that has to match external formats bit for bit */
+static int runSelfTest(void)
+{
+    // 'available' (NULL: always) tells whether a check has what it needs to run
+    static const struct
+    {
+        const char *name;
+        bool (*check)(void);
+        bool (*available)(void);
+    } checks[] = {
+        {"Polyglot book keys", bookCheckKeys, NULL},
+        {"NNUE kernels and incremental accumulator", nnueSelfCheck, NULL},
+        {"Packed positions and move codec", packedSelfCheck, NULL},
+        {"Syzygy KQvK/KRvK/KPvK probes", tbSelfCheck, tbSelfCheckAvailable},
+    };
+    int count = (int)(sizeof(checks) / sizeof(checks[0]));
+
+    int run = 0, failures = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (checks[i].available && !checks[i].available())
+        {
+            printf("skip %s (not loaded)\n", checks[i].name);
+            continue;
+        }
+        bool ok = checks[i].check();
+        printf("%s %s\n", ok ? "ok  " : "FAIL", checks[i].name);
+        run++;
+        failures += !ok;
+    }
+    printf("\n%d/%d checks passed\n", run - failures, run);
+    return failures ? 1 : 0;
+}
+
+static void printUsage(const char *program)
+{
+    printf("Usage: %s [command] [options]\n\n", program);
+    printf("Commands (default: play a game against the engine):\n");
+    printf("  perft [depth]     Count leaf nodes of the position; without depth, run the reference suite\n");
+    printf("  divide <depth>    Perft split by root move\n");
+    printf("  bench [depth]     Deterministic search benchmark; total nodes are the signature (default depth %d)\n",
+           BENCH_DEPTH);
+    printf("  microbench        Time per call of move generation, make/undo, evaluation and attack tests\n");
+    printf("  smpbench          Lazy SMP scaling benchmark (1-16 threads)\n");
+    printf("  selftest          Check the book keys, NNUE kernels and accumulator, packed formats and loaded tablebases\n");
+    printf("  uci               Speak the UCI protocol on stdin/stdout (for GUIs and match runners)\n");
+    printf("  batch             Analyze FEN/EPD lines in parallel, one JSON result per line\n");
+    printf("  pack              Convert FEN/EPD lines to %d-byte binary positions\n", PACKED_POSITION_SIZE);
+    printf("  unpack            Convert a binary position file back to FEN lines\n");
+    printf("  games             Print a binary game file, one game per line\n\n");
+    printf("Options:\n");
+    printf("  --fen <FEN>       Position for perft/divide (default: start position)\n");
+    printf("  --hash <MB>       Transposition table size (default %d)\n", TT_DEFAULT_MB);
+    printf("  --pawnhash <MB>   Pawn structure table size (default %d)\n", PAWN_HASH_DEFAULT_MB);
+    printf("  --syzygy <DIRS>   Syzygy tablebase directories, separated by ':'\n");
+    printf("  --book <FILE>     Polyglot opening book the AI plays from while in book\n");
+    printf("  --nnue <FILE>     Evaluate with this NNUE network instead of the classical terms\n");
+    printf("  --threads <N>     Search threads (default 1); number of workers for batch\n");
+    printf("  --input <FILE>    Input of batch and pack (default: stdin); unpack and games need a file\n");
+    printf("  --output <FILE>   Output of batch, pack, unpack and games (default: stdout)\n");
+    printf("  --record <FILE>   Append the game played to this binary game file\n");
+    printf("  --privatehash <MB> Private table per batch worker instead of the shared one\n");
+    printf("  --depth <N>       Deepest iteration searched, 0 = no cap (default %d)\n", DEFAULT_SEARCH_DEPTH);
+    printf("  --movetime <MS>   Time budget per AI move\n");
+    printf("  --nodes <N>       Node budget per AI move\n");
+    printf("  --multipv <N>     Best moves batch reports per position, each with its line (max %d)\n", MAX_MULTI_PV);
+    printf("  --param <P>=<V>   Set a search parameter, e.g. lmr=0 or rfpMargin=120\n");
+    printf("                    (switches: nullMove, lmr, reverseFutility, futility)\n");
+}
+
+int main(int argc, char *argv[])
 {
     BoardState board;
+    size_t hashMB = TT_DEFAULT_MB;
+    size_t pawnHashMB = PAWN_HASH_DEFAULT_MB;
+    SearchParams params;
+    initSearchParams(&params);
+    SearchLimits limits = {DEFAULT_SEARCH_DEPTH, 0, 0, NULL, 1, &params, NULL, NULL, NULL, 1, false};
+    bool depthGiven = false;
+    const char *command = NULL;
+    const char *fen = START_FEN;
+    const char *syzygyPath = NULL;
+    const char *bookPath = NULL;
+    const char *nnuePath = NULL;
+    const char *batchInput = NULL;
+    const char *batchOutput = NULL;
+    const char *recordPath = NULL;
+    size_t privateHashMB = 0;
+    int commandDepth = 0;
+
+    // 0. Command Line (optional command and its depth first, then options)
+    int first = 1;
+    if (argc > 1 && argv[1][0] != '-')
+        command = argv[first++];
+    if (command && first < argc && isdigit((unsigned char)argv[first][0]))
+        commandDepth = atoi(argv[first++]);
+
+    for (int i = first; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--hash") && i + 1 < argc)
+        {
+            hashMB = (size_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (!strcmp(argv[i], "--pawnhash") && i + 1 < argc)
+        {
+            pawnHashMB = (size_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (!strcmp(argv[i], "--input") && i + 1 < argc)
+        {
+            batchInput = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--output") && i + 1 < argc)
+        {
+            batchOutput = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--record") && i + 1 < argc)
+        {
+            recordPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--privatehash") && i + 1 < argc)
+        {
+            privateHashMB = (size_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (!strcmp(argv[i], "--nnue") && i + 1 < argc)
+        {
+            nnuePath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--book") && i + 1 < argc)
+        {
+            bookPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--syzygy") && i + 1 < argc)
+        {
+            syzygyPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--fen") && i + 1 < argc)
+        {
+            fen = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--threads") && i + 1 < argc)
+        {
+            limits.threads = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--depth") && i + 1 < argc)
+        {
+            limits.depth = atoi(argv[++i]);
+            depthGiven = true;
+        }
+        else if (!strcmp(argv[i], "--movetime") && i + 1 < argc)
+        {
+            limits.timeMs = strtoll(argv[++i], NULL, 10);
+        }
+        else if (!strcmp(argv[i], "--nodes") && i + 1 < argc)
+        {
+            limits.nodes = strtoull(argv[++i], NULL, 10);
+        }
+        else if (!strcmp(argv[i], "--multipv") && i + 1 < argc)
+        {
+            limits.multiPV = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--param") && i + 1 < argc)
+        {
+            // name=value; the name is cut off in place at the '='
+            char *name = argv[++i];
+            char *eq = strchr(name, '=');
+            if (eq)
+                *eq = '\0';
+            if (!eq || !setSearchParam(&params, name, atoi(eq + 1)))
+            {
+                printf("Unknown search parameter: %s\n", name);
+                return 1;
+            }
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Engine Initialization (tables must exist before any board is set up)
+    initAttacks();
+    initZobrist();
+    initEval();
+    if (!ttInit(hashMB))
+    {
+        printf("Could not allocate a %zu MB transposition table.\n", hashMB);
+        return 1;
+    }
+    if (!pawnHashInit(pawnHashMB))
+    {
+        printf("Could not allocate a %zu MB pawn hash table.\n", pawnHashMB);
+        ttFree();
+        return 1;
+    }
+    if (syzygyPath)
+    {
+        int files = tbInit(syzygyPath); // Before tbLargest(): argument order is unspecified
+        printf("Syzygy: %d tablebase files, up to %d pieces\n", files, tbLargest());
+    }
+    if (bookPath && !bookInit(bookPath))
+        printf("Could not open the opening book %s, playing without it.\n", bookPath);
+    if (nnuePath && !nnueInit(nnuePath))
+        printf("Could not load the network %s, using the classical evaluation.\n", nnuePath);
+
+    // Non-interactive commands
+    if (command)
+    {
+        int status = 1;
+        bool needsBoard = !strcmp(command, "divide") || (!strcmp(command, "perft") && commandDepth > 0);
+        if (needsBoard && !loadBoardFromFEN(fen, &board))
+            printf("Invalid FEN: %s\n", fen);
+        else if (!strcmp(command, "perft") && commandDepth > 0)
+        {
+            int64_t start = nowMs();
+            uint64_t nodes = perft(&board, commandDepth);
+            int64_t elapsed = nowMs() - start;
+            printf("Nodes: %llu\nTime: %lld ms (%.0f nodes/sec)\n", (unsigned long long)nodes, (long long)elapsed,
+                   elapsed > 0 ? (double)nodes * 1000.0 / (double)elapsed : 0.0);
+            status = 0;
+        }
+        else if (!strcmp(command, "perft"))
+            status = runPerftSuite();
+        else if (!strcmp(command, "divide") && commandDepth > 0)
+        {
+            divide(&board, commandDepth);
+            status = 0;
+        }
+        else if (!strcmp(command, "bench"))
+            status = runBench(commandDepth > 0 ? commandDepth : depthGiven ? limits.depth : BENCH_DEPTH, &params);
+        else if (!strcmp(command, "microbench"))
+            status = runMicroBench();
+        else if (!strcmp(command, "smpbench"))
+            status = runSmpBench(depthGiven ? limits.depth : SMP_BENCH_DEPTH);
+        else if (!strcmp(command, "selftest"))
+            status = runSelfTest();
+        else if (!strcmp(command, "uci"))
+            status = runUci(&params, limits.threads, false);
+        else if (!strcmp(command, "batch"))
+        {
+            BatchOptions batch = {batchInput, batchOutput, limits.threads, privateHashMB, limits};
+            status = runBatch(&batch);
+        }
+        else if (!strcmp(command, "pack"))
+            status = runPack(batchInput, batchOutput);
+        else if (!strcmp(command, "unpack"))
+            status = runUnpack(batchInput, batchOutput);
+        else if (!strcmp(command, "games"))
+            status = runDumpGames(batchInput, batchOutput);
+        else
+            printUsage(argv[0]);
+        nnueFree();
+        bookFree();
+        tbFree();
+        pawnHashFree();
+        ttFree();
+        return status;
+    }
 
     // 1. Game Initialization
     // Try to load a saved game, otherwise set up the standard chess board.
     if (!loadBoardFromFile("board.txt", &board))
     {
         printf("Starting new game.\n");
-        const char *start[8] = {
-            "rnbqkbnr", "pppppppp", "........", "........",
-            "........", "........", "PPPPPPPP", "RNBQKBNR"};
-        // Parse the initial strings into the board array
-        for (int r = 0; r < 8; r++)
-            for (int c = 0; c < 8; c++)
-                board.squares[r][c] = charToPiece(start[r][c]);
-
-        // Set initial state
-        board.currentPlayer = WHITE;
-        board.castling = (CastlingRights){1, 1, 1, 1};
-        board.enPassantTarget = (Position){-1, -1};
-        board.halfmoveClock = 0;
-        board.fullmoveNumber = 1;
+        loadBoardFromFEN(START_FEN, &board);
     }
 
+    // Moves and AI scores of the game, appended to the record file when it ends
+    GameRecord record;
+    bool recording = recordPath && gameRecordStart(&record, &board);
+    uint64_t bookRandom = 0; // Book pick state, seeded on the first probe
+    int gameResult = PACKED_RESULT_UNKNOWN;
+
     // 2. The Game Loop
     while (1)
     {
@@ -230,7 +465,8 @@ int main()
         // ---------------------------------------------------------
         // We generate all legal moves for the *current* player.
         // If count is 0, the game is over (Checkmate or Stalemate).
-        MoveList moves = generateAllLegalMoves(&board);
+        MoveList moves;
+        generateAllLegalMoves(&board, &moves);
 
         if (moves.count == 0)
         {
@@ -240,6 +476,7 @@ int main()
                 printf("\n============================\n");
                 printf("CHECKMATE! %s wins.\n", board.currentPlayer == WHITE ? "Black (AI)" : "White (You)");
                 printf("============================\n");
+                gameResult = (board.currentPlayer == WHITE) ? PACKED_RESULT_BLACK_WINS : PACKED_RESULT_WHITE_WINS;
             }
             else
             {
@@ -247,6 +484,7 @@ int main()
                 printf("\n============================\n");
                 printf("STALEMATE! The game is a draw.\n");
                 printf("============================\n");
+                gameResult = PACKED_RESULT_DRAW;
             }
 
             // Deleteing saved board state, if it exists
@@ -271,6 +509,19 @@ int main()
             // Check Commands
             if (!strcmp(input, "quit"))
                 break;
+            if (!strcmp(input, "uci"))
+            {
+                // A GUI started us without the "uci" command: hand stdin over to it
+                int status = runUci(&params, limits.threads, true);
+                if (recording)
+                    gameRecordFree(&record);
+                nnueFree();
+                bookFree();
+                tbFree();
+                pawnHashFree();
+                ttFree();
+                return status;
+            }
             if (!strcmp(input, "save"))
             {
                 saveBoardToFile("board.txt", &board);
@@ -283,9 +534,12 @@ int main()
 
             // Resolve against legal moves to get flags
             Move finalMove;
-            if (parsed.from.row != -1 && resolveMove(&board, parsed, &finalMove))
+            if (!IS_NO_MOVE(parsed) && resolveMove(&board, parsed, &finalMove))
             {
-                makeMove(&board, finalMove);
+                MoveRecord played; // Game moves are never taken back
+                makeMove(&board, finalMove, &played);
+                if (recording)
+                    gameRecordAdd(&record, finalMove, PACKED_NO_SCORE);
             }
             else
             {
@@ -295,13 +549,28 @@ int main()
         else
         {
             // --- AI TURN (BLACK) ---
+            // Book moves need no search
+            Move best;
+            if (bookProbe(&board, &bookRandom, &best))
+            {
+                printf("\nAI plays: ");
+                printMove(best);
+                printf("(book)\n");
+                MoveRecord played;
+                makeMove(&board, best, &played);
+                if (recording)
+                    gameRecordAdd(&record, best, PACKED_NO_SCORE);
+                continue;
+            }
+
             printf("\nAI is thinking...\n");
 
             // AI finds the best move
-            Move best = findBestMove(&board);
+            SearchResult info;
+            best = findBestMove(&board, &limits, &info);
 
             // Sanity check: Should never happen if game-over logic above is correct
-            if (best.from.row == -1)
+            if (IS_NO_MOVE(best))
             {
                 printf("AI resigns (Error or Mate).\n");
                 break;
@@ -309,11 +578,32 @@ int main()
 
             printf("AI plays: ");
             printMove(best);
+            printf("(depth %d, %llu nodes, %lld ms)\n", info.depth,
+                   (unsigned long long)info.nodes, (long long)info.timeMs);
 
             // Execute AI move
-            makeMove(&board, best);
+            MoveRecord played;
+            makeMove(&board, best, &played);
+            if (recording)
+                gameRecordAdd(&record, best, packScore(info.score));
         }
     }
 
+    if (recording)
+    {
+        FILE *file = openPackedAppend(recordPath);
+        bool saved = file && gameRecordWrite(file, &record, gameResult);
+        if (file && fclose(file) != 0)
+            saved = false;
+        if (!saved)
+            printf("Could not record the game to %s.\n", recordPath);
+        gameRecordFree(&record);
+    }
+
+    nnueFree();
+    bookFree();
+    tbFree();
+    pawnHashFree();
+    ttFree();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,328 @@
+#include "movegen.h"
+#include "attacks.h"
+#include "game.h"
+
+/*
+ * Every generator takes the next free slot of the output buffer and returns
+ * the slot after the last move it wrote, so generators chain without counters.
+ */
+
+// Most moves a single piece can have: a queen in the middle of an empty board has 27
+#define MAX_PIECE_MOVES 32
+
+/* ---------- Adders ---------- */
+
+static Move *addMove(Move *out, int from, int to, PieceType promotion, int flag)
+{
+    *out = (Move){(uint8_t)from, (uint8_t)to, (uint8_t)promotion, (uint8_t)flag};
+    return out + 1;
+}
+
+// Emits a normal move to every square of 'targets'
+static Move *addMovesToTargets(Move *out, int from, Bitboard targets)
+{
+    while (targets)
+        out = addMove(out, from, popLsb(&targets), EMPTY, MOVE_NORMAL);
+    return out;
+}
+
+// Promoting to a queen is noisy; the under-promotions are searched with the quiet moves
+static Move *addPromotions(Move *out, int from, int to, GenType type)
+{
+    if (type != GEN_QUIET)
+        out = addMove(out, from, to, QUEEN, MOVE_PROMOTION);
+    if (type != GEN_NOISY)
+    {
+        out = addMove(out, from, to, ROOK, MOVE_PROMOTION);
+        out = addMove(out, from, to, BISHOP, MOVE_PROMOTION);
+        out = addMove(out, from, to, KNIGHT, MOVE_PROMOTION);
+    }
+    return out;
+}
+
+// Squares a non-pawn piece may move to for the requested kind of move
+static Bitboard targetMask(const BoardState *board, GenType type)
+{
+    PieceColor opponent = (board->currentPlayer == WHITE) ? BLACK : WHITE;
+    switch (type)
+    {
+    case GEN_NOISY:
+        return board->colorBB[opponent];
+    case GEN_QUIET:
+        return ~board->occupiedBB;
+    default:
+        return ~board->colorBB[board->currentPlayer];
+    }
+}
+
+/* ---------- Piece Generators ---------- */
+
+static Move *generatePawnMoves(BoardState *board, Move *out, int sq, GenType type)
+{
+    PieceColor player = board->currentPlayer;
+    PieceColor opponent = (player == WHITE) ? BLACK : WHITE;
+    int dir = (player == WHITE) ? -1 : 1;
+    int startRow = (player == WHITE) ? 6 : 1;
+    int promotionRank = (player == WHITE) ? 0 : 7;
+    int r = SQ_ROW(sq);
+
+    // A pawn on its last rank only appears in broken setups; it has no moves
+    if (r + dir < 0 || r + dir > 7)
+        return out;
+    bool promotes = (r + dir == promotionRank);
+
+    // 1. Pushes (single and double)
+    int push = sq + 8 * dir;
+    if (!(board->occupiedBB & BIT(push)))
+    {
+        if (promotes)
+            out = addPromotions(out, sq, push, type);
+        else if (type != GEN_NOISY)
+        {
+            out = addMove(out, sq, push, EMPTY, MOVE_NORMAL);
+            if (r == startRow && !(board->occupiedBB & BIT(push + 8 * dir)))
+                out = addMove(out, sq, push + 8 * dir, EMPTY, MOVE_NORMAL);
+        }
+    }
+
+    // 2. Captures
+    Bitboard attacks = pawnAttacks[player][sq];
+    Bitboard captures = attacks & board->colorBB[opponent];
+    while (captures)
+    {
+        int to = popLsb(&captures);
+        if (promotes)
+            out = addPromotions(out, sq, to, type);
+        else if (type != GEN_QUIET)
+            out = addMove(out, sq, to, EMPTY, MOVE_NORMAL);
+    }
+
+    // 3. En Passant
+    Position ep = board->enPassantTarget;
+    if (type != GEN_QUIET && ep.row != -1 && (attacks & BIT(SQ(ep.row, ep.col))))
+        out = addMove(out, sq, SQ(ep.row, ep.col), EMPTY, MOVE_EN_PASSANT);
+
+    return out;
+}
+
+static Move *generateCastling(BoardState *board, Move *out)
+{
+    PieceColor player = board->currentPlayer;
+    PieceColor opponent = (player == WHITE) ? BLACK : WHITE;
+
+    if (isKingInCheck(board, player))
+        return out;
+
+    if (player == WHITE)
+    {
+        if (board->castling.wk && board->squares[7][5].type == EMPTY && board->squares[7][6].type == EMPTY &&
+            !isSquareAttacked(board, 7, 5, opponent) && !isSquareAttacked(board, 7, 6, opponent))
+            out = addMove(out, SQ(7, 4), SQ(7, 6), EMPTY, MOVE_CASTLE_KING);
+        if (board->castling.wq && board->squares[7][1].type == EMPTY && board->squares[7][2].type == EMPTY &&
+            board->squares[7][3].type == EMPTY && !isSquareAttacked(board, 7, 2, opponent) && !isSquareAttacked(board, 7, 3, opponent))
+            out = addMove(out, SQ(7, 4), SQ(7, 2), EMPTY, MOVE_CASTLE_QUEEN);
+    }
+    else
+    {
+        if (board->castling.bk && board->squares[0][5].type == EMPTY && board->squares[0][6].type == EMPTY &&
+            !isSquareAttacked(board, 0, 5, opponent) && !isSquareAttacked(board, 0, 6, opponent))
+            out = addMove(out, SQ(0, 4), SQ(0, 6), EMPTY, MOVE_CASTLE_KING);
+        if (board->castling.bq && board->squares[0][1].type == EMPTY && board->squares[0][2].type == EMPTY &&
+            board->squares[0][3].type == EMPTY && !isSquareAttacked(board, 0, 2, opponent) && !isSquareAttacked(board, 0, 3, opponent))
+            out = addMove(out, SQ(0, 4), SQ(0, 2), EMPTY, MOVE_CASTLE_QUEEN);
+    }
+    return out;
+}
+
+// --- Dispatcher for the piece standing on 'sq' ---
+static Move *generatePieceMoves(BoardState *board, Move *out, int sq, GenType type)
+{
+    PieceType piece = board->squares[SQ_ROW(sq)][SQ_COL(sq)].type;
+    switch (piece)
+    {
+    case PAWN:
+        return generatePawnMoves(board, out, sq, type);
+    case KING:
+        out = addMovesToTargets(out, sq, kingAttacks[sq] & targetMask(board, type));
+        return (type != GEN_NOISY) ? generateCastling(board, out) : out;
+    case KNIGHT:
+    case BISHOP:
+    case ROOK:
+    case QUEEN:
+        return addMovesToTargets(out, sq, pieceAttacks(piece, sq, board->occupiedBB) & targetMask(board, type));
+    default:
+        return out;
+    }
+}
+
+/* ---------- Public API ---------- */
+
+int generateMoves(BoardState *board, Move *moves, GenType type)
+{
+    Move *out = moves;
+
+    // Visit only the side to move's pieces instead of scanning all 64 squares
+    Bitboard own = board->colorBB[board->currentPlayer];
+    while (own)
+        out = generatePieceMoves(board, out, popLsb(&own), type);
+
+    return (int)(out - moves);
+}
+
+void computeCheckInfo(const BoardState *board, CheckInfo *info)
+{
+    PieceColor us = board->currentPlayer;
+    PieceColor them = (us == WHITE) ? BLACK : WHITE;
+
+    info->kingSq = -1;
+    info->checkers = info->pinned = 0;
+    int ksq = board->kingSq[us];
+    if (ksq < 0)
+        return;
+
+    info->kingSq = ksq;
+    info->checkers = attackersTo(board, ksq, board->occupiedBB) & board->colorBB[them];
+
+    // An enemy slider lined up with the king pins the single piece between them
+    const Bitboard *enemy = board->pieceBB[them];
+    Bitboard snipers = (rookAttacks(ksq, 0) & (enemy[ROOK] | enemy[QUEEN])) |
+                       (bishopAttacks(ksq, 0) & (enemy[BISHOP] | enemy[QUEEN]));
+    while (snipers)
+    {
+        Bitboard blockers = betweenBB[ksq][popLsb(&snipers)] & board->occupiedBB;
+        if (blockers && !(blockers & (blockers - 1)))
+            info->pinned |= blockers & board->colorBB[us];
+    }
+}
+
+// En passant removes two pieces from one line at once; just play it and look
+static bool isLegalEnPassant(BoardState *board, Move move)
+{
+    PieceColor us = board->currentPlayer;
+    MoveRecord undo;
+    makeMove(board, move, &undo);
+    bool legal = !isKingInCheck(board, us);
+    undoMove(board, &undo);
+    return legal;
+}
+
+// A king step is safe when no enemy attacks the target with the king off the board
+static bool isSafeKingStep(const BoardState *board, int from, int to)
+{
+    PieceColor them = (board->currentPlayer == WHITE) ? BLACK : WHITE;
+    return !(attackersTo(board, to, board->occupiedBB ^ BIT(from)) & board->colorBB[them]);
+}
+
+bool isLegalMove(BoardState *board, Move move, const CheckInfo *info)
+{
+    int ksq = info->kingSq;
+    if (ksq < 0)
+        return true;
+
+    // Castling is only generated when the king's path is safe
+    if (move.from == ksq)
+        return move.flag == MOVE_CASTLE_KING || move.flag == MOVE_CASTLE_QUEEN || isSafeKingStep(board, ksq, move.to);
+    if (move.flag == MOVE_EN_PASSANT)
+        return isLegalEnPassant(board, move);
+
+    if (info->checkers)
+    {
+        // Double check: only the king may move. Single check: capture or block.
+        if (info->checkers & (info->checkers - 1))
+            return false;
+        if (!(BIT(move.to) & (info->checkers | betweenBB[ksq][lsb(info->checkers)])))
+            return false;
+    }
+    return !(info->pinned & BIT(move.from)) || (lineBB[ksq][move.from] & BIT(move.to));
+}
+
+int generateLegalMoves(BoardState *board, Move *moves)
+{
+    CheckInfo info;
+    computeCheckInfo(board, &info);
+    if (info.kingSq < 0)
+        return generateMoves(board, moves, GEN_ALL);
+
+    PieceColor us = board->currentPlayer;
+    int ksq = info.kingSq;
+    Move *out = moves;
+
+    // 1. King steps, each verified against the enemy attacks
+    Bitboard steps = kingAttacks[ksq] & ~board->colorBB[us];
+    while (steps)
+    {
+        int to = popLsb(&steps);
+        if (isSafeKingStep(board, ksq, to))
+            out = addMove(out, ksq, to, EMPTY, MOVE_NORMAL);
+    }
+
+    // 2. In double check nothing else helps
+    if (info.checkers & (info.checkers - 1))
+        return (int)(out - moves);
+
+    // 3. Everyone else may only land on the checker or between it and the king
+    Bitboard evasion = ~0ULL;
+    if (info.checkers)
+        evasion = info.checkers | betweenBB[ksq][lsb(info.checkers)];
+    else
+        out = generateCastling(board, out);
+
+    Bitboard own = board->colorBB[us] & ~BIT(ksq);
+    while (own)
+    {
+        int from = popLsb(&own);
+        Bitboard allowed = evasion;
+        if (info.pinned & BIT(from))
+            allowed &= lineBB[ksq][from];
+
+        PieceType piece = board->squares[SQ_ROW(from)][SQ_COL(from)].type;
+        if (piece != PAWN)
+        {
+            Bitboard targets = pieceAttacks(piece, from, board->occupiedBB) & ~board->colorBB[us] & allowed;
+            out = addMovesToTargets(out, from, targets);
+            continue;
+        }
+
+        // Pawns: generate, then keep the moves that land inside the allowed set
+        Move *first = out;
+        Move *last = generatePawnMoves(board, first, from, GEN_ALL);
+        for (Move *m = first; m < last; m++)
+        {
+            bool legal = (m->flag == MOVE_EN_PASSANT) ? isLegalEnPassant(board, *m) : (BIT(m->to) & allowed) != 0;
+            if (legal)
+                *out++ = *m;
+        }
+    }
+
+    return (int)(out - moves);
+}
+
+void generateAllLegalMoves(BoardState *board, MoveList *list)
+{
+    list->count = generateLegalMoves(board, list->moves);
+}
+
+bool isPseudoLegal(BoardState *board, Move move)
+{
+    if (move.from > 63 || move.to > 63 || IS_NO_MOVE(move))
+        return false;
+    if (!(board->colorBB[board->currentPlayer] & BIT(move.from)))
+        return false;
+
+    // Regenerate the moving piece's moves: cheap, and exact by construction
+    Move buffer[MAX_PIECE_MOVES];
+    int count = (int)(generatePieceMoves(board, buffer, move.from, GEN_ALL) - buffer);
+    for (int i = 0; i < count; i++)
+        if (sameMove(buffer[i], move) && buffer[i].flag == move.flag)
+            return true;
+    return false;
+}
+
+bool isNoisyMove(const BoardState *board, Move move)
+{
+    if (move.flag == MOVE_EN_PASSANT)
+        return true;
+    if (move.flag == MOVE_PROMOTION)
+        return move.promotion == QUEEN;
+    return (board->occupiedBB & BIT(move.to)) != 0;
+}
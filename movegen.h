@@ -0,0 +1,89 @@
+#ifndef MOVEGEN_H
+#define MOVEGEN_H
+
+#include <stdbool.h>
+#include "structs.h"
+
+/*
+ * Move generation.
+ *
+ * Generators write into a buffer owned by the caller (the search keeps one per
+ * ply) and return how many moves they wrote, so no move list is ever copied.
+ * The pseudo-legal generators can be split into two groups so a node that
+ * cuts off on a capture never pays for its quiet moves:
+ *
+ *   GEN_NOISY : captures, en passant and queen promotions
+ *   GEN_QUIET : everything else, including castling and under-promotions
+ *
+ * Pseudo-legal moves may leave the mover's own king in check. The legal
+ * generator avoids that from the start: it finds the checking and pinned
+ * pieces once, moves pinned pieces only along their pin ray, answers a check
+ * only with king moves, captures of the checker or blocks, and verifies just
+ * king steps and en passant individually. isLegalMove() applies the same
+ * rules to single pseudo-legal moves for the staged search.
+ */
+
+typedef enum
+{
+    GEN_NOISY,
+    GEN_QUIET,
+    GEN_ALL
+} GenType;
+
+/* Check and pin information for the side to move, computed once per position */
+typedef struct
+{
+    int kingSq;        // -1 if the side to move has no king (hand-made positions)
+    Bitboard checkers; // Enemy pieces giving check
+    Bitboard pinned;   // Own pieces that may only move along the ray to their king
+} CheckInfo;
+
+/**
+ * @brief Fills 'info' for the side to move.
+ */
+void computeCheckInfo(const BoardState *board, CheckInfo *info);
+
+/**
+ * @brief True if the pseudo-legal 'move' does not leave the mover's king in check.
+ * @param info computeCheckInfo() of the current position.
+ */
+bool isLegalMove(BoardState *board, Move move, const CheckInfo *info);
+
+/**
+ * @brief Writes the pseudo-legal moves of the side to move of the given kind into 'moves'
+ * (room for MAX_MOVES_IN_LIST entries).
+ * @return Number of moves written.
+ */
+int generateMoves(BoardState *board, Move *moves, GenType type);
+
+/**
+ * @brief Writes every fully legal move (checks included) into 'moves'.
+ * @return Number of moves written.
+ */
+int generateLegalMoves(BoardState *board, Move *moves);
+
+/**
+ * @brief Fills 'list' with every legal move of the side to move.
+ */
+void generateAllLegalMoves(BoardState *board, MoveList *list);
+
+/**
+ * @brief True if 'move' is one the side to move could generate in this position.
+ * Moves that come from elsewhere (TT, killer slots) must pass this before being played.
+ */
+bool isPseudoLegal(BoardState *board, Move move);
+
+/**
+ * @brief True for moves GEN_NOISY produces: captures, en passant and queen promotions.
+ */
+bool isNoisyMove(const BoardState *board, Move move);
+
+/**
+ * @brief Move identity as far as the search is concerned (squares and promotion piece).
+ */
+static inline bool sameMove(Move a, Move b)
+{
+    return a.from == b.from && a.to == b.to && a.promotion == b.promotion;
+}
+
+#endif // MOVEGEN_H
@@ -0,0 +1,504 @@
+#include "nnue.h"
+#include "fileio.h"
+#include "game.h"
+#include "movegen.h"
+#include "zobrist.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#define HEADER_SIZE 64
+#define NET_VERSION 1
+#define NET_SIZE (HEADER_SIZE + sizeof(int16_t) * ((size_t)NNUE_INPUTS * NNUE_HIDDEN + 3 * NNUE_HIDDEN + 1))
+
+bool nnueActive = false;
+
+static MappedFile net; // Whole file, header included
+
+// Bumped whenever the network changes: accumulators built for an older one are rebuilt
+static uint32_t networkGeneration = 1;
+
+static const int16_t *featureWeights; // [NNUE_INPUTS][NNUE_HIDDEN]
+static const int16_t *featureBias;    // [NNUE_HIDDEN]
+static const int16_t *outputWeights;  // [2][NNUE_HIDDEN]: side to move, then the other side
+static int32_t outputBias;
+
+/* ---------- Vector Kernels ---------- */
+
+/*
+ * The three operations the network needs, on NNUE_HIDDEN int16 lanes. Loads
+ * are unaligned: boards live on the stack and in malloc'd thread data alike.
+ * The widest instruction set the compiler targets is used (make NATIVE=1 for
+ * AVX2 on x86; SSE2 is always there on x86-64, NEON on 64-bit ARM). The
+ * scalar versions are the fallback and the reference nnueSelfCheck() holds
+ * the vector code to.
+ */
+
+#if defined(__AVX2__)
+#define KERNEL_NAME "AVX2"
+#elif defined(__SSE2__)
+#define KERNEL_NAME "SSE2"
+#elif defined(__ARM_NEON)
+#define KERNEL_NAME "NEON"
+#else
+#define KERNEL_NAME "scalar"
+#endif
+
+static void addColumnScalar(int16_t *acc, const int16_t *column)
+{
+    for (int i = 0; i < NNUE_HIDDEN; i++)
+        acc[i] = (int16_t)(acc[i] + column[i]);
+}
+
+static void subColumnScalar(int16_t *acc, const int16_t *column)
+{
+    for (int i = 0; i < NNUE_HIDDEN; i++)
+        acc[i] = (int16_t)(acc[i] - column[i]);
+}
+
+static int32_t dotClippedScalar(const int16_t *acc, const int16_t *weights)
+{
+    int32_t sum = 0;
+    for (int i = 0; i < NNUE_HIDDEN; i++)
+    {
+        int32_t a = acc[i] < 0 ? 0 : acc[i] > NNUE_QA ? NNUE_QA : acc[i];
+        sum += a * weights[i];
+    }
+    return sum;
+}
+
+static void addColumn(int16_t *acc, const int16_t *column)
+{
+#if defined(__AVX2__)
+    for (int i = 0; i < NNUE_HIDDEN; i += 16)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(acc + i));
+        __m256i w = _mm256_loadu_si256((const __m256i *)(column + i));
+        _mm256_storeu_si256((__m256i *)(acc + i), _mm256_add_epi16(a, w));
+    }
+#elif defined(__SSE2__)
+    for (int i = 0; i < NNUE_HIDDEN; i += 8)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)(acc + i));
+        __m128i w = _mm_loadu_si128((const __m128i *)(column + i));
+        _mm_storeu_si128((__m128i *)(acc + i), _mm_add_epi16(a, w));
+    }
+#elif defined(__ARM_NEON)
+    for (int i = 0; i < NNUE_HIDDEN; i += 8)
+        vst1q_s16(acc + i, vaddq_s16(vld1q_s16(acc + i), vld1q_s16(column + i)));
+#else
+    addColumnScalar(acc, column);
+#endif
+}
+
+static void subColumn(int16_t *acc, const int16_t *column)
+{
+#if defined(__AVX2__)
+    for (int i = 0; i < NNUE_HIDDEN; i += 16)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(acc + i));
+        __m256i w = _mm256_loadu_si256((const __m256i *)(column + i));
+        _mm256_storeu_si256((__m256i *)(acc + i), _mm256_sub_epi16(a, w));
+    }
+#elif defined(__SSE2__)
+    for (int i = 0; i < NNUE_HIDDEN; i += 8)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)(acc + i));
+        __m128i w = _mm_loadu_si128((const __m128i *)(column + i));
+        _mm_storeu_si128((__m128i *)(acc + i), _mm_sub_epi16(a, w));
+    }
+#elif defined(__ARM_NEON)
+    for (int i = 0; i < NNUE_HIDDEN; i += 8)
+        vst1q_s16(acc + i, vsubq_s16(vld1q_s16(acc + i), vld1q_s16(column + i)));
+#else
+    subColumnScalar(acc, column);
+#endif
+}
+
+/* Sum of clamp(acc, 0, QA) * weight over all lanes */
+static int32_t dotClipped(const int16_t *acc, const int16_t *weights)
+{
+#if defined(__AVX2__)
+    const __m256i zero = _mm256_setzero_si256(), ceiling = _mm256_set1_epi16(NNUE_QA);
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < NNUE_HIDDEN; i += 16)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(acc + i));
+        __m256i w = _mm256_loadu_si256((const __m256i *)(weights + i));
+        a = _mm256_min_epi16(_mm256_max_epi16(a, zero), ceiling);
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(a, w));
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(half);
+#elif defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128(), ceiling = _mm_set1_epi16(NNUE_QA);
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < NNUE_HIDDEN; i += 8)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)(acc + i));
+        __m128i w = _mm_loadu_si128((const __m128i *)(weights + i));
+        a = _mm_min_epi16(_mm_max_epi16(a, zero), ceiling);
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(a, w));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+#elif defined(__ARM_NEON)
+    const int16x8_t zero = vdupq_n_s16(0), ceiling = vdupq_n_s16(NNUE_QA);
+    int32x4_t sum = vdupq_n_s32(0);
+    for (int i = 0; i < NNUE_HIDDEN; i += 8)
+    {
+        int16x8_t a = vminq_s16(vmaxq_s16(vld1q_s16(acc + i), zero), ceiling);
+        int16x8_t w = vld1q_s16(weights + i);
+        sum = vmlal_s16(sum, vget_low_s16(a), vget_low_s16(w));
+        sum = vmlal_s16(sum, vget_high_s16(a), vget_high_s16(w));
+    }
+    return vgetq_lane_s32(sum, 0) + vgetq_lane_s32(sum, 1) + vgetq_lane_s32(sum, 2) + vgetq_lane_s32(sum, 3);
+#else
+    return dotClippedScalar(acc, weights);
+#endif
+}
+
+/* ---------- Features ---------- */
+
+/* Square as seen by 'perspective': its own side moving up the board */
+static int orient(int sq, int perspective)
+{
+    return (perspective == WHITE) ? sq : sq ^ 56;
+}
+
+/* King bucket of 'perspective' (bit 5: board mirrored), -1 without a king */
+static int kingKey(const BoardState *board, int perspective)
+{
+    if (board->kingSq[perspective] < 0)
+        return -1;
+    int king = orient(board->kingSq[perspective], perspective);
+    int mirror = SQ_COL(king) >= 4;
+    if (mirror)
+        king ^= 7;
+    return (SQ_ROW(king) * 4 + SQ_COL(king)) | mirror << 5;
+}
+
+static const int16_t *featureColumn(int perspective, int key, Piece piece, int sq)
+{
+    int square = orient(sq, perspective);
+    if (key & 32)
+        square ^= 7;
+    int kind = ((int)piece.color == perspective ? 0 : 5) + (int)piece.type - PAWN;
+    int feature = (key & 31) * 640 + kind * 64 + square;
+    return featureWeights + (size_t)feature * NNUE_HIDDEN;
+}
+
+/* Full rebuild of one perspective */
+static void refreshPerspective(const BoardState *board, int16_t *values, int perspective, int key)
+{
+    memcpy(values, featureBias, sizeof(int16_t) * NNUE_HIDDEN);
+    for (int color = WHITE; color <= BLACK; color++)
+        for (int type = PAWN; type < KING; type++)
+        {
+            Bitboard b = board->pieceBB[color][type];
+            while (b)
+            {
+                int sq = popLsb(&b);
+                addColumn(values, featureColumn(perspective, key, (Piece){type, color}, sq));
+            }
+        }
+}
+
+static void updatePiece(BoardState *board, Piece piece, int sq, bool add)
+{
+    NNUEAccumulator *acc = &board->nnue;
+    if (acc->network != networkGeneration)
+        return; // Built for another network: rebuilt from scratch on the next evaluation
+    for (int perspective = WHITE; perspective <= BLACK; perspective++)
+    {
+        if (acc->kingKey[perspective] < 0)
+            continue;
+        int key = kingKey(board, perspective);
+        if (key != acc->kingKey[perspective])
+        {
+            // The king changed bucket since the last rebuild: sums are for another feature set
+            acc->kingKey[perspective] = -1;
+            continue;
+        }
+        const int16_t *column = featureColumn(perspective, key, piece, sq);
+        if (add)
+            addColumn(acc->values[perspective], column);
+        else
+            subColumn(acc->values[perspective], column);
+    }
+}
+
+/* ---------- Public API ---------- */
+
+static uint32_t readLittleEndian(const uint8_t *p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/* Checks the header of a whole network image and points the weight arrays into it */
+static bool useNetwork(const uint8_t *data)
+{
+    if (memcmp(data, "CNUE", 4) || readLittleEndian(data + 4) != NET_VERSION ||
+        readLittleEndian(data + 8) != NNUE_HIDDEN || readLittleEndian(data + 12) != NNUE_INPUTS)
+        return false;
+
+    // The header keeps the int16 arrays aligned
+    featureWeights = (const int16_t *)(const void *)(data + HEADER_SIZE);
+    featureBias = featureWeights + (size_t)NNUE_INPUTS * NNUE_HIDDEN;
+    outputWeights = featureBias + NNUE_HIDDEN;
+    outputBias = outputWeights[2 * NNUE_HIDDEN];
+    networkGeneration++;
+    nnueActive = true;
+    return true;
+}
+
+bool nnueInit(const char *path)
+{
+    nnueFree();
+    if (!path || !*path)
+        return true;
+
+    // The weights are used in place, so the host must share the file's byte order
+    const uint16_t probe = 1;
+    if (*(const uint8_t *)&probe != 1)
+        return false;
+
+    if (!mapFile(path, &net))
+        return false;
+    if (net.size != NET_SIZE || !useNetwork(net.data))
+    {
+        nnueFree();
+        return false;
+    }
+    return true;
+}
+
+void nnueFree(void)
+{
+    unmapFile(&net);
+    nnueActive = false;
+    networkGeneration++;
+}
+
+void nnueReset(BoardState *board)
+{
+    board->nnue.kingKey[WHITE] = -1;
+    board->nnue.kingKey[BLACK] = -1;
+}
+
+void nnueAddPiece(BoardState *board, Piece piece, int sq)
+{
+    updatePiece(board, piece, sq, true);
+}
+
+void nnueRemovePiece(BoardState *board, Piece piece, int sq)
+{
+    updatePiece(board, piece, sq, false);
+}
+
+int nnueEvaluate(BoardState *board)
+{
+    NNUEAccumulator *acc = &board->nnue;
+    if (acc->network != networkGeneration)
+    {
+        acc->kingKey[WHITE] = acc->kingKey[BLACK] = -1;
+        acc->network = networkGeneration;
+    }
+    for (int perspective = WHITE; perspective <= BLACK; perspective++)
+    {
+        int key = kingKey(board, perspective);
+        if (acc->kingKey[perspective] != key)
+        {
+            refreshPerspective(board, acc->values[perspective], perspective, key);
+            acc->kingKey[perspective] = key;
+        }
+#ifdef DEBUG
+        // Debug builds verify the incremental sums against a full rebuild
+        int16_t check[NNUE_HIDDEN];
+        refreshPerspective(board, check, perspective, key);
+        assert(!memcmp(check, acc->values[perspective], sizeof(check)));
+#endif
+    }
+
+    PieceColor us = board->currentPlayer;
+    PieceColor them = (us == WHITE) ? BLACK : WHITE;
+    int64_t sum = (int64_t)dotClipped(acc->values[us], outputWeights) +
+                  dotClipped(acc->values[them], outputWeights + NNUE_HIDDEN) + outputBias;
+    int score = (int)(sum * NNUE_SCALE / (NNUE_QA * NNUE_QB));
+    return (us == WHITE) ? score : -score;
+}
+
+/* ---------- Self-Check ---------- */
+
+#define CHECK_PLIES 96 // Deepest line of a random game
+
+static void writeLittleEndian(uint8_t *p, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+        p[i] = (uint8_t)(value >> (8 * i));
+}
+
+/*
+ * A network file image of random weights. Feature weights are small enough
+ * that no accumulator overflows, and large enough that the sums of a full
+ * board cross both ends of the clipped ReLU.
+ */
+static uint8_t *generateNetwork(uint64_t seed)
+{
+    uint8_t *data = calloc(1, NET_SIZE);
+    if (!data)
+        return NULL;
+    memcpy(data, "CNUE", 4);
+    writeLittleEndian(data + 4, NET_VERSION);
+    writeLittleEndian(data + 8, NNUE_HIDDEN);
+    writeLittleEndian(data + 12, NNUE_INPUTS);
+
+    int16_t *values = (int16_t *)(void *)(data + HEADER_SIZE);
+    size_t count = (NET_SIZE - HEADER_SIZE) / sizeof(int16_t);
+    size_t firstOutput = (size_t)NNUE_INPUTS * NNUE_HIDDEN + NNUE_HIDDEN;
+    for (size_t i = 0; i < count; i++)
+    {
+        int range = (i < firstOutput) ? 128 : 256;
+        values[i] = (int16_t)((int)(nextRandom(&seed) % (uint64_t)range) - range / 2);
+    }
+    return data;
+}
+
+/* Vector kernels against the scalar code, on full-range values and unaligned buffers */
+static bool checkKernels(uint64_t *seed)
+{
+    for (int round = 0; round < 1000; round++)
+    {
+        int16_t accBuffer[NNUE_HIDDEN + 1], columnBuffer[NNUE_HIDDEN + 1], expected[NNUE_HIDDEN];
+        int16_t *acc = accBuffer + (round & 1), *column = columnBuffer + ((round >> 1) & 1);
+        for (int i = 0; i < NNUE_HIDDEN; i++)
+        {
+            acc[i] = (int16_t)nextRandom(seed);
+            column[i] = (int16_t)nextRandom(seed);
+        }
+
+        if (dotClipped(acc, column) != dotClippedScalar(acc, column))
+            return false;
+
+        memcpy(expected, acc, sizeof(expected));
+        addColumnScalar(expected, column);
+        addColumn(acc, column);
+        if (memcmp(expected, acc, sizeof(expected)))
+            return false;
+
+        subColumnScalar(expected, column);
+        subColumn(acc, column);
+        if (memcmp(expected, acc, sizeof(expected)))
+            return false;
+    }
+    return true;
+}
+
+/* The board's accumulator and evaluation against a rebuild from scratch */
+static bool matchesRebuild(BoardState *board)
+{
+    int score = nnueEvaluate(board);
+    for (int perspective = WHITE; perspective <= BLACK; perspective++)
+    {
+        int16_t rebuilt[NNUE_HIDDEN];
+        int key = kingKey(board, perspective);
+        refreshPerspective(board, rebuilt, perspective, key);
+        if (board->nnue.kingKey[perspective] != key || memcmp(rebuilt, board->nnue.values[perspective], sizeof(rebuilt)))
+            return false;
+    }
+    BoardState fresh = *board;
+    nnueReset(&fresh);
+    return nnueEvaluate(&fresh) == score;
+}
+
+/*
+ * Random games, moves made and taken back. As in a search, several moves may
+ * pass between two evaluations (a king leaving its bucket and coming back).
+ */
+static bool checkGames(uint64_t *seed)
+{
+    for (int p = 0; p < CHECK_FEN_COUNT; p++)
+    {
+        BoardState board;
+        if (!loadBoardFromFEN(checkFENs[p], &board) || !matchesRebuild(&board))
+            return false;
+
+        MoveRecord records[CHECK_PLIES];
+        int ply = 0;
+        for (int step = 0; step < 2000; step++)
+        {
+            MoveList list;
+            generateAllLegalMoves(&board, &list);
+            bool back = ply == CHECK_PLIES || list.count == 0 || nextRandom(seed) % 4 == 0;
+            if (back && ply == 0)
+                break;
+            if (back)
+                undoMove(&board, &records[--ply]);
+            else
+                makeMove(&board, list.moves[nextRandom(seed) % (uint64_t)list.count], &records[ply++]);
+            if (nextRandom(seed) % 3 == 0 && !matchesRebuild(&board))
+                return false;
+        }
+        if (!matchesRebuild(&board))
+            return false;
+    }
+    return true;
+}
+
+bool nnueSelfCheck(void)
+{
+    bool loaded = nnueActive; // The user's network goes back in place afterwards
+    uint64_t seed = 0x4E4E5545ULL;
+
+    bool ok = checkKernels(&seed);
+    if (!ok)
+        printf("NNUE: the %s kernels disagree with the scalar code\n", KERNEL_NAME);
+
+    uint8_t *first = generateNetwork(1), *second = generateNetwork(2);
+    if (first && second)
+    {
+        useNetwork(first);
+        if (!checkGames(&seed))
+        {
+            printf("NNUE: incremental accumulator differs from a full rebuild (%s kernels)\n", KERNEL_NAME);
+            ok = false;
+        }
+
+        // A board evaluated with one network must not be reused as is by the next
+        BoardState board;
+        loadBoardFromFEN(START_FEN, &board);
+        nnueEvaluate(&board);
+        useNetwork(second);
+        if (!matchesRebuild(&board))
+        {
+            printf("NNUE: accumulator not rebuilt after a network change\n");
+            ok = false;
+        }
+    }
+    else
+    {
+        printf("NNUE: no memory for the test networks\n");
+        ok = false;
+    }
+    free(first);
+    free(second);
+
+    if (!loaded || !useNetwork(net.data))
+    {
+        nnueActive = false;
+        networkGeneration++;
+    }
+    return ok;
+}
@@ -0,0 +1,79 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include <stdbool.h>
+#include "structs.h"
+
+/*
+ * Efficiently updatable neural network evaluation.
+ *
+ * Features are king-relative: every non-king piece is one input per
+ * (king bucket, piece kind, square), seen from each side with its own king.
+ * The board is oriented so that side moves up, and mirrored so its king is
+ * on files a-d, which leaves 32 king buckets of 640 inputs each.
+ *
+ * Network: 20480 inputs -> 256 neurons per perspective (int16, clipped ReLU)
+ * -> 1 output over both perspectives, side to move first. The first layer
+ * is BoardState.nnue: putPiece/removePiece add or subtract one weight column
+ * per perspective, so a move costs a few vector adds instead of a full
+ * recompute. Only a king leaving its bucket invalidates that perspective,
+ * which is then rebuilt on the next evaluation.
+ *
+ * Network file (little-endian, memory-mapped):
+ *   64-byte header: "CNUE", version, hidden size, input count (uint32 each), zero padding
+ *   int16 featureWeights[NNUE_INPUTS][NNUE_HIDDEN]  (scaled by NNUE_QA)
+ *   int16 featureBias[NNUE_HIDDEN]                  (scaled by NNUE_QA)
+ *   int16 outputWeights[2 * NNUE_HIDDEN]            (scaled by NNUE_QB)
+ *   int16 outputBias                                (scaled by NNUE_QA * NNUE_QB)
+ */
+
+#define NNUE_KING_BUCKETS 32
+#define NNUE_INPUTS (NNUE_KING_BUCKETS * 10 * 64)
+#define NNUE_QA 255      // First-layer quantization; also the clipped ReLU ceiling
+#define NNUE_QB 64       // Output-layer quantization
+#define NNUE_SCALE 400   // Network output units to centipawns
+
+// True while a network is loaded; makeMove/undoMove only maintain accumulators then
+extern bool nnueActive;
+
+/**
+ * @brief Maps the network file at 'path', replacing the current one.
+ * An empty path just unloads, returning to the classical evaluation.
+ * Accumulators built for the previous network are rebuilt on their next
+ * evaluation, so boards set up before the call stay valid.
+ * @return false if the file is missing or not a network of this architecture
+ * (the previous network is unloaded either way).
+ */
+bool nnueInit(const char *path);
+
+/**
+ * @brief Unloads the network.
+ */
+void nnueFree(void);
+
+/**
+ * @brief Marks both perspectives of the board's accumulator stale (rebuilt on the next evaluation).
+ */
+void nnueReset(BoardState *board);
+
+/**
+ * @brief Accumulator updates for a non-king piece appearing on or leaving 'sq'.
+ */
+void nnueAddPiece(BoardState *board, Piece piece, int sq);
+void nnueRemovePiece(BoardState *board, Piece piece, int sq);
+
+/**
+ * @brief Network evaluation, from White's point of view like evaluateBoard().
+ * Both kings must be on the board.
+ */
+int nnueEvaluate(BoardState *board);
+
+/**
+ * @brief Checks the vector kernels this build uses against the scalar code, and
+ * the incremental accumulator against full rebuilds over random games, using
+ * generated networks. A loaded network is kept.
+ * @return false (after printing what failed) on any mismatch.
+ */
+bool nnueSelfCheck(void);
+
+#endif // NNUE_H
@@ -0,0 +1,538 @@
+#include "packed.h"
+#include "ai.h"
+#include "bitboard.h"
+#include "fileio.h"
+#include "game.h"
+#include "movegen.h"
+#include "zobrist.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define PACKED_IO_BUFFER (1 << 20) // stdio buffer of output streams
+#define GAME_RECORD_INITIAL_MOVES 128
+
+// Move kinds in the packed move's top two bits
+#define KIND_NORMAL 0
+#define KIND_PROMOTION 1
+#define KIND_EN_PASSANT 2
+#define KIND_CASTLE 3
+
+/* ---------- Helpers ---------- */
+
+static uint64_t readLittleEndian(const uint8_t *p, int bytes)
+{
+    uint64_t value = 0;
+    for (int i = bytes - 1; i >= 0; i--)
+        value = (value << 8) | p[i];
+    return value;
+}
+
+static void writeLittleEndian(uint8_t *p, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+        p[i] = (uint8_t)(value >> (8 * i));
+}
+
+/* Our squares count from a8, the file format's from a1: the ranks are mirrored */
+static int fileSquare(int sq)
+{
+    return sq ^ 56;
+}
+
+static Bitboard mirrorRanks(Bitboard b)
+{
+    Bitboard mirrored = 0;
+    for (int rank = 0; rank < 8; rank++)
+        mirrored |= ((b >> (8 * rank)) & 0xFFULL) << (8 * (7 - rank));
+    return mirrored;
+}
+
+/* ---------- Positions ---------- */
+
+bool packPosition(const BoardState *board, PackedPosition *packed)
+{
+    Bitboard occupied = mirrorRanks(board->occupiedBB);
+    if (popCount(occupied) > 32)
+        return false;
+
+    uint8_t *b = packed->bytes;
+    memset(b, 0, PACKED_POSITION_SIZE);
+    writeLittleEndian(b, occupied, 8);
+
+    // One nibble per piece, in the order the occupancy lists the squares
+    for (int i = 0; occupied; i++)
+    {
+        int sq = fileSquare(popLsb(&occupied));
+        Piece p = board->squares[SQ_ROW(sq)][SQ_COL(sq)];
+        unsigned nibble = (unsigned)p.type | (p.color == BLACK ? 8u : 0u);
+        b[8 + i / 2] |= (uint8_t)(nibble << (4 * (i & 1)));
+    }
+
+    b[24] = (uint8_t)((board->currentPlayer == BLACK) | board->castling.wk << 1 | board->castling.wq << 2 |
+                      board->castling.bk << 3 | board->castling.bq << 4);
+    b[25] = (uint8_t)(board->enPassantTarget.row >= 0 ? board->enPassantTarget.col + 1 : 0);
+    int halfmove = board->halfmoveClock;
+    b[26] = (uint8_t)(halfmove < 0 ? 0 : halfmove > 255 ? 255 : halfmove);
+    int fullmove = board->fullmoveNumber;
+    writeLittleEndian(b + 28, (uint64_t)(fullmove < 1 ? 1 : fullmove > 65535 ? 65535 : fullmove), 2);
+    return true;
+}
+
+bool unpackPosition(const PackedPosition *packed, BoardState *board)
+{
+    const uint8_t *b = packed->bytes;
+    BoardState parsed;
+
+    Bitboard occupied = readLittleEndian(b, 8);
+    if (popCount(occupied) > 32 || b[25] > 8)
+        return false;
+
+    for (int r = 0; r < 8; r++)
+        for (int c = 0; c < 8; c++)
+            parsed.squares[r][c] = (Piece){EMPTY, NO_COLOR};
+    for (int i = 0; occupied; i++)
+    {
+        int sq = fileSquare(popLsb(&occupied));
+        unsigned nibble = (b[8 + i / 2] >> (4 * (i & 1))) & 0xFu;
+        unsigned type = nibble & 7u;
+        if (type < PAWN || type > KING)
+            return false;
+        parsed.squares[SQ_ROW(sq)][SQ_COL(sq)] = (Piece){(PieceType)type, (nibble & 8u) ? BLACK : WHITE};
+    }
+
+    parsed.currentPlayer = (b[24] & 1) ? BLACK : WHITE;
+    parsed.castling = (CastlingRights){(b[24] >> 1) & 1, (b[24] >> 2) & 1, (b[24] >> 3) & 1, (b[24] >> 4) & 1};
+
+    // The target lies behind a pawn that just moved: rank 6 with White to move, rank 3 with Black
+    parsed.enPassantTarget = (Position){-1, -1};
+    if (b[25])
+        parsed.enPassantTarget = (Position){parsed.currentPlayer == WHITE ? 2 : 5, b[25] - 1};
+
+    parsed.halfmoveClock = b[26];
+    parsed.fullmoveNumber = (int)readLittleEndian(b + 28, 2);
+
+    refreshBoardState(&parsed);
+    *board = parsed;
+    return true;
+}
+
+bool packFEN(const char *fen, PackedPosition *packed)
+{
+    BoardState board;
+    return loadBoardFromFEN(fen, &board) && packPosition(&board, packed);
+}
+
+bool unpackFEN(const PackedPosition *packed, char *fen)
+{
+    BoardState board;
+    if (!unpackPosition(packed, &board))
+        return false;
+    boardToFEN(&board, fen);
+    return true;
+}
+
+bool writePackedPositions(FILE *file, const PackedPosition *positions, size_t count)
+{
+    return fwrite(positions, PACKED_POSITION_SIZE, count, file) == count;
+}
+
+/* ---------- Moves and Scores ---------- */
+
+uint16_t packedEncodeMove(Move move)
+{
+    unsigned kind = KIND_NORMAL, promotion = 0;
+    if (move.flag == MOVE_PROMOTION)
+    {
+        kind = KIND_PROMOTION;
+        promotion = (unsigned)(move.promotion - KNIGHT);
+    }
+    else if (move.flag == MOVE_EN_PASSANT)
+        kind = KIND_EN_PASSANT;
+    else if (move.flag == MOVE_CASTLE_KING || move.flag == MOVE_CASTLE_QUEEN)
+        kind = KIND_CASTLE;
+
+    return (uint16_t)((unsigned)fileSquare(move.from) | (unsigned)fileSquare(move.to) << 6 | promotion << 12 |
+                      kind << 14);
+}
+
+Move packedDecodeMove(uint16_t code)
+{
+    Move move = {(uint8_t)fileSquare(code & 63), (uint8_t)fileSquare((code >> 6) & 63), EMPTY, MOVE_NORMAL};
+    switch (code >> 14)
+    {
+    case KIND_PROMOTION:
+        move.flag = MOVE_PROMOTION;
+        move.promotion = (uint8_t)(KNIGHT + ((code >> 12) & 3));
+        break;
+    case KIND_EN_PASSANT:
+        move.flag = MOVE_EN_PASSANT;
+        break;
+    case KIND_CASTLE:
+        // The king lands on the g or c file
+        move.flag = (SQ_COL(move.to) == 6) ? MOVE_CASTLE_KING : MOVE_CASTLE_QUEEN;
+        break;
+    }
+    return move;
+}
+
+int16_t packScore(int score)
+{
+    if (IS_MATE_SCORE(score))
+    {
+        int plies = MATE_VALUE - abs(score);
+        return (int16_t)(score > 0 ? PACKED_MATE_SCORE - plies : plies - PACKED_MATE_SCORE);
+    }
+    // Evaluations (and tablebase wins) stop short of the mate range
+    int limit = PACKED_MATE_SCORE - MAX_PLY;
+    return (int16_t)(score > limit ? limit : score < -limit ? -limit : score);
+}
+
+int unpackScore(int16_t packed)
+{
+    if (packed > PACKED_MATE_SCORE - MAX_PLY)
+        return MATE_VALUE - (PACKED_MATE_SCORE - packed);
+    if (packed < -(PACKED_MATE_SCORE - MAX_PLY))
+        return -MATE_VALUE + (PACKED_MATE_SCORE + packed);
+    return packed;
+}
+
+/* ---------- Writing Games ---------- */
+
+bool gameRecordStart(GameRecord *game, const BoardState *board)
+{
+    game->moves = NULL;
+    game->count = 0;
+    game->capacity = 0;
+    return packPosition(board, &game->start);
+}
+
+bool gameRecordAdd(GameRecord *game, Move move, int16_t score)
+{
+    if (game->count >= PACKED_MAX_GAME_MOVES)
+        return false;
+    if (game->count == game->capacity)
+    {
+        int capacity = game->capacity ? game->capacity * 2 : GAME_RECORD_INITIAL_MOVES;
+        uint8_t *moves = realloc(game->moves, (size_t)capacity * PACKED_MOVE_SIZE);
+        if (!moves)
+            return false;
+        game->moves = moves;
+        game->capacity = capacity;
+    }
+
+    uint8_t *entry = game->moves + (size_t)game->count++ * PACKED_MOVE_SIZE;
+    writeLittleEndian(entry, packedEncodeMove(move), 2);
+    writeLittleEndian(entry + 2, (uint16_t)score, 2);
+    return true;
+}
+
+bool gameRecordWrite(FILE *file, const GameRecord *game, int result)
+{
+    uint8_t header[PACKED_GAME_HEADER_SIZE] = {0};
+    memcpy(header, game->start.bytes, PACKED_POSITION_SIZE);
+    writeLittleEndian(header + PACKED_POSITION_SIZE, (uint64_t)game->count, 2);
+    header[PACKED_POSITION_SIZE + 2] = (uint8_t)result;
+
+    size_t count = (size_t)game->count;
+    return fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+           (count == 0 || fwrite(game->moves, PACKED_MOVE_SIZE, count, file) == count);
+}
+
+void gameRecordFree(GameRecord *game)
+{
+    free(game->moves);
+    game->moves = NULL;
+    game->count = 0;
+    game->capacity = 0;
+}
+
+FILE *openPackedAppend(const char *path)
+{
+    FILE *file = fopen(path, "ab");
+    if (file)
+        setvbuf(file, NULL, _IOFBF, PACKED_IO_BUFFER);
+    return file;
+}
+
+/* ---------- Reading ---------- */
+
+bool packedFileOpen(PackedFile *file, const char *path)
+{
+    return mapFile(path, file); // An empty file holds no records
+}
+
+void packedFileClose(PackedFile *file)
+{
+    unmapFile(file);
+}
+
+size_t packedPositionCount(const PackedFile *file)
+{
+    return file->size / PACKED_POSITION_SIZE;
+}
+
+const PackedPosition *packedPositionAt(const PackedFile *file, size_t index)
+{
+    // PackedPosition is a plain byte array: any address is suitably aligned
+    return (const PackedPosition *)(file->data + index * PACKED_POSITION_SIZE);
+}
+
+bool packedNextGame(const PackedFile *file, size_t *offset, PackedGame *game)
+{
+    if (*offset + PACKED_GAME_HEADER_SIZE > file->size)
+        return false;
+    const uint8_t *header = file->data + *offset;
+    int count = (int)readLittleEndian(header + PACKED_POSITION_SIZE, 2);
+    size_t length = PACKED_GAME_HEADER_SIZE + (size_t)count * PACKED_MOVE_SIZE;
+    if (*offset + length > file->size)
+        return false;
+
+    game->start = (const PackedPosition *)header;
+    game->result = header[PACKED_POSITION_SIZE + 2];
+    game->count = count;
+    game->moves = header + PACKED_GAME_HEADER_SIZE;
+    *offset += length;
+    return true;
+}
+
+void packedGameMove(const PackedGame *game, int index, Move *move, int16_t *score)
+{
+    const uint8_t *entry = game->moves + (size_t)index * PACKED_MOVE_SIZE;
+    *move = packedDecodeMove((uint16_t)readLittleEndian(entry, 2));
+    *score = (int16_t)readLittleEndian(entry + 2, 2);
+}
+
+/* ---------- Self Check ---------- */
+
+#define CHECK_GAMES 16 // Random games from each start position
+#define CHECK_PLIES 96 // Longest one
+
+/* The position, and every legal move in it, must come back unchanged */
+static bool roundTrips(BoardState *board, const MoveList *moves)
+{
+    PackedPosition packed;
+    BoardState unpacked;
+    char before[FEN_MAX_LENGTH], after[FEN_MAX_LENGTH];
+    if (!packPosition(board, &packed) || !unpackPosition(&packed, &unpacked))
+        return false;
+    boardToFEN(board, before);
+    boardToFEN(&unpacked, after);
+    if (strcmp(before, after) != 0 || unpacked.hash != board->hash)
+    {
+        printf("Packed: %s came back as %s\n", before, after);
+        return false;
+    }
+
+    for (int i = 0; i < moves->count; i++)
+    {
+        Move move = moves->moves[i], decoded = packedDecodeMove(packedEncodeMove(move));
+        if (decoded.from != move.from || decoded.to != move.to || decoded.flag != move.flag ||
+            decoded.promotion != move.promotion)
+        {
+            char text[6];
+            moveToString(move, text);
+            printf("Packed: move %s of %s does not survive the move codec\n", text, before);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool packedSelfCheck(void)
+{
+    uint64_t seed = 0x5041434BULL;
+
+    // Random games reach en passant targets and every mix of castling rights
+    for (int p = 0; p < CHECK_FEN_COUNT; p++)
+        for (int game = 0; game < CHECK_GAMES; game++)
+        {
+            BoardState board;
+            if (!loadBoardFromFEN(checkFENs[p], &board))
+                return false;
+            for (int ply = 0; ply <= CHECK_PLIES; ply++)
+            {
+                MoveList list;
+                generateAllLegalMoves(&board, &list);
+                if (!roundTrips(&board, &list))
+                    return false;
+                if (list.count == 0)
+                    break;
+                MoveRecord record;
+                makeMove(&board, list.moves[nextRandom(&seed) % (uint64_t)list.count], &record);
+            }
+        }
+
+    // Clocks beyond their fields are clamped, not wrapped
+    BoardState board, unpacked;
+    PackedPosition packed;
+    loadBoardFromFEN(START_FEN, &board);
+    board.halfmoveClock = 300;
+    board.fullmoveNumber = 70000;
+    if (!packPosition(&board, &packed) || !unpackPosition(&packed, &unpacked) || unpacked.halfmoveClock != 255 ||
+        unpacked.fullmoveNumber != 65535)
+    {
+        printf("Packed: move clocks are not clamped to 255 and 65535\n");
+        return false;
+    }
+    return true;
+}
+
+/* ---------- Converters ---------- */
+
+#define PACK_LINE_LENGTH 512
+#define PACK_CHUNK 4096 // Positions written per fwrite
+
+/* A converter's output: 'path', or stdout for NULL, with a large buffer */
+static FILE *openOutput(const char *path, const char *mode)
+{
+    FILE *out = path ? fopen(path, mode) : stdout;
+    if (out)
+        setvbuf(out, NULL, _IOFBF, PACKED_IO_BUFFER);
+    else
+        fprintf(stderr, "Could not create %s\n", path);
+    return out;
+}
+
+/* A converter's binary input; it is mapped, so it has to be a file */
+static bool openInput(PackedFile *file, const char *path)
+{
+    if (path && packedFileOpen(file, path))
+        return true;
+    fprintf(stderr, "Could not open %s\n", path ? path : "(no --input)");
+    return false;
+}
+
+/* Flushes and closes 'out'; false if anything failed to reach it */
+static bool closeOutput(FILE *out)
+{
+    bool ok = fflush(out) == 0 && !ferror(out);
+    if (out != stdout)
+        ok = (fclose(out) == 0) && ok;
+    return ok;
+}
+
+int runPack(const char *input, const char *output)
+{
+    FILE *in = input ? fopen(input, "r") : stdin;
+    if (!in)
+    {
+        fprintf(stderr, "Could not open %s\n", input);
+        return 1;
+    }
+    FILE *out = openOutput(output, "wb");
+    if (!out)
+    {
+        if (in != stdin)
+            fclose(in);
+        return 1;
+    }
+
+    static PackedPosition chunk[PACK_CHUNK];
+    size_t pending = 0, packed = 0, invalid = 0;
+    bool ok = true;
+    char line[PACK_LINE_LENGTH];
+    while (ok && fgets(line, sizeof(line), in))
+    {
+        const char *start = line;
+        while (*start == ' ' || *start == '\t')
+            start++;
+        if (!*start || *start == '\n' || *start == '\r' || *start == '#')
+            continue;
+
+        if (!packFEN(start, &chunk[pending]))
+        {
+            invalid++;
+            continue;
+        }
+        if (++pending == PACK_CHUNK)
+        {
+            ok = writePackedPositions(out, chunk, pending);
+            packed += pending;
+            pending = 0;
+        }
+    }
+    if (ok && pending)
+        ok = writePackedPositions(out, chunk, pending);
+    packed += pending;
+
+    if (in != stdin)
+        fclose(in);
+    ok = closeOutput(out) && ok;
+    fprintf(stderr, "Packed %zu positions (%zu invalid lines skipped)\n", packed, invalid);
+    return ok ? 0 : 1;
+}
+
+int runUnpack(const char *input, const char *output)
+{
+    PackedFile file;
+    if (!openInput(&file, input))
+        return 1;
+    FILE *out = openOutput(output, "w");
+    if (!out)
+    {
+        packedFileClose(&file);
+        return 1;
+    }
+
+    size_t count = packedPositionCount(&file), invalid = 0;
+    char fen[FEN_MAX_LENGTH];
+    for (size_t i = 0; i < count; i++)
+    {
+        if (unpackFEN(packedPositionAt(&file, i), fen))
+            fprintf(out, "%s\n", fen);
+        else
+            invalid++;
+    }
+    if (file.size % PACKED_POSITION_SIZE)
+        fprintf(stderr, "Ignoring %zu trailing bytes\n", file.size % PACKED_POSITION_SIZE);
+
+    packedFileClose(&file);
+    bool ok = closeOutput(out);
+    fprintf(stderr, "Unpacked %zu positions (%zu invalid skipped)\n", count - invalid, invalid);
+    return ok ? 0 : 1;
+}
+
+int runDumpGames(const char *input, const char *output)
+{
+    PackedFile file;
+    if (!openInput(&file, input))
+        return 1;
+    FILE *out = openOutput(output, "w");
+    if (!out)
+    {
+        packedFileClose(&file);
+        return 1;
+    }
+
+    static const char *results[] = {"*", "1-0", "1/2-1/2", "0-1"};
+    size_t offset = 0, games = 0;
+    PackedGame game;
+    char fen[FEN_MAX_LENGTH];
+    while (packedNextGame(&file, &offset, &game))
+    {
+        if (!unpackFEN(game.start, fen))
+            strcpy(fen, "(invalid position)");
+        fprintf(out, "%s | %s |", fen, game.result <= PACKED_RESULT_BLACK_WINS ? results[game.result] : "?");
+        for (int i = 0; i < game.count; i++)
+        {
+            Move move;
+            int16_t score;
+            packedGameMove(&game, i, &move, &score);
+            char text[6];
+            moveToString(move, text);
+            if (score == PACKED_NO_SCORE)
+                fprintf(out, " %s -", text);
+            else
+                fprintf(out, " %s %d", text, unpackScore(score));
+        }
+        fputc('\n', out);
+        games++;
+    }
+    if (offset != file.size)
+        fprintf(stderr, "Stopped at a truncated game at byte %zu\n", offset);
+
+    packedFileClose(&file);
+    bool ok = closeOutput(out);
+    fprintf(stderr, "Read %zu games\n", games);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,209 @@
+#ifndef PACKED_H
+#define PACKED_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "fileio.h"
+#include "structs.h"
+
+/*
+ * Compact binary positions and game records, for training data and result
+ * pipelines that move millions of positions. Every multi-byte field is
+ * little-endian and squares count from a1 = 0 (h8 = 63), so files are
+ * portable between machines and independent of the engine's own numbering.
+ *
+ * Packed position (PACKED_POSITION_SIZE bytes):
+ *   0-7    occupancy bitboard
+ *   8-23   one nibble per occupied square, in ascending square order, low
+ *          nibble first: piece type (1 pawn ... 6 king), +8 for black
+ *   24     bit 0 black to move, bits 1-4 castling rights K, Q, k, q
+ *   25     en passant file + 1 (0 = none); the rank follows from the side to move
+ *   26     halfmove clock (capped at 255)
+ *   27     reserved, 0
+ *   28-29  fullmove number (capped at 65535)
+ *   30-31  reserved, 0
+ * At most 32 pieces fit, which every legal position satisfies.
+ *
+ * Game file: games appended one after another, no file header, so files
+ * can be concatenated. Each game is
+ *   packed start position
+ *   uint16 move count, uint8 result (PACKED_RESULT_*), uint8 reserved
+ *   per move: uint16 move (from | to << 6 | promotion << 12 | kind << 14)
+ *             int16 score from the mover's side (PACKED_NO_SCORE if none)
+ * where promotion is 0 knight ... 3 queen and kind is 0 normal,
+ * 1 promotion, 2 en passant, 3 castling (king move e1g1, e1c1, ...).
+ */
+
+#define PACKED_POSITION_SIZE 32
+#define PACKED_GAME_HEADER_SIZE (PACKED_POSITION_SIZE + 4)
+#define PACKED_MOVE_SIZE 4
+#define PACKED_MAX_GAME_MOVES 65535
+
+#define PACKED_NO_SCORE INT16_MIN
+#define PACKED_MATE_SCORE 32000 // Mate in N plies is stored as PACKED_MATE_SCORE - N
+
+enum
+{
+    PACKED_RESULT_UNKNOWN,
+    PACKED_RESULT_WHITE_WINS,
+    PACKED_RESULT_DRAW,
+    PACKED_RESULT_BLACK_WINS
+};
+
+typedef struct
+{
+    uint8_t bytes[PACKED_POSITION_SIZE];
+} PackedPosition;
+
+/* ---------- Positions ---------- */
+
+/**
+ * @brief Encodes 'board'.
+ * @return false if it has more than 32 pieces.
+ */
+bool packPosition(const BoardState *board, PackedPosition *packed);
+
+/**
+ * @brief Decodes a position into a fully set up board, as loadBoardFromFEN() does.
+ * @return false for an invalid encoding (board left untouched).
+ */
+bool unpackPosition(const PackedPosition *packed, BoardState *board);
+
+/**
+ * @brief FEN converters; 'fen' needs FEN_MAX_LENGTH chars (see fileio.h).
+ * @return false for an invalid FEN or encoding.
+ */
+bool packFEN(const char *fen, PackedPosition *packed);
+bool unpackFEN(const PackedPosition *packed, char *fen);
+
+/**
+ * @brief Writes 'count' positions to a stream opened in binary mode.
+ */
+bool writePackedPositions(FILE *file, const PackedPosition *positions, size_t count);
+
+/* ---------- Moves and Scores ---------- */
+
+uint16_t packedEncodeMove(Move move);
+Move packedDecodeMove(uint16_t code);
+
+/**
+ * @brief Search scores to int16: evaluations are clamped below the mate
+ * range, mates keep their distance. unpackScore() returns the engine's
+ * scale; PACKED_NO_SCORE has to be checked for before.
+ */
+int16_t packScore(int score);
+int unpackScore(int16_t packed);
+
+/* ---------- Writing Games ---------- */
+
+/**
+ * @brief A game being recorded: its start position and the moves played since.
+ */
+typedef struct
+{
+    PackedPosition start;
+    uint8_t *moves; // PACKED_MOVE_SIZE bytes per move, already in file layout
+    int count;
+    int capacity;
+} GameRecord;
+
+/**
+ * @brief Starts recording a game from 'board'.
+ * @return false if the position cannot be packed.
+ */
+bool gameRecordStart(GameRecord *game, const BoardState *board);
+
+/**
+ * @brief Adds a move and its score: packScore() of the search result, or
+ * PACKED_NO_SCORE for moves that were not searched.
+ * @return false when out of memory or past PACKED_MAX_GAME_MOVES.
+ */
+bool gameRecordAdd(GameRecord *game, Move move, int16_t score);
+
+/**
+ * @brief Appends the game to 'file' with its result (PACKED_RESULT_*).
+ */
+bool gameRecordWrite(FILE *file, const GameRecord *game, int result);
+
+void gameRecordFree(GameRecord *game);
+
+/**
+ * @brief Opens 'path' for appending records, with a large stdio buffer so
+ * batches of games cost few system calls.
+ */
+FILE *openPackedAppend(const char *path);
+
+/* ---------- Reading ---------- */
+
+/**
+ * @brief A whole position or game file, memory-mapped where mmap() is available
+ * (see mapFile() in fileio.h).
+ */
+typedef MappedFile PackedFile;
+
+bool packedFileOpen(PackedFile *file, const char *path);
+void packedFileClose(PackedFile *file);
+
+/**
+ * @brief Zero-copy access to a position file: 'index' < packedPositionCount().
+ */
+size_t packedPositionCount(const PackedFile *file);
+const PackedPosition *packedPositionAt(const PackedFile *file, size_t index);
+
+/**
+ * @brief One game of a game file, pointing into the file's memory.
+ */
+typedef struct
+{
+    const PackedPosition *start;
+    int result;
+    int count;
+    const uint8_t *moves;
+} PackedGame;
+
+/**
+ * @brief Reads the game at '*offset' (start at 0) and advances past it.
+ * @return false at the end of the file or at a truncated game.
+ */
+bool packedNextGame(const PackedFile *file, size_t *offset, PackedGame *game);
+
+/**
+ * @brief Move 'index' of a game and the score recorded with it (PACKED_NO_SCORE if none).
+ */
+void packedGameMove(const PackedGame *game, int index, Move *move, int16_t *score);
+
+/* ---------- Self Check ---------- */
+
+/**
+ * @brief Packs and unpacks the positions of random games from checkFENs
+ * (fileio.h): en passant targets, castling rights and move clocks, clamped
+ * ones included, must come back unchanged, and so must every legal move
+ * through packedEncodeMove()/packedDecodeMove().
+ * @return false (after printing the first mismatch) on any difference.
+ */
+bool packedSelfCheck(void);
+
+/* ---------- Converters ---------- */
+
+/**
+ * @brief "pack": FEN/EPD lines (NULL = stdin) to a position file (NULL = stdout).
+ * Blank lines and lines starting with '#' are skipped; invalid ones are
+ * counted and reported on stderr.
+ * @return 0 on success, 1 if a file could not be opened or written.
+ */
+int runPack(const char *input, const char *output);
+
+/**
+ * @brief "unpack": a position file back to one FEN per line (NULL = stdout).
+ */
+int runUnpack(const char *input, const char *output);
+
+/**
+ * @brief "games": one text line per game of a game file:
+ * <start FEN> | <1-0, 1/2-1/2, 0-1 or *> | <move> <score> ... ("-" for no score).
+ */
+int runDumpGames(const char *input, const char *output);
+
+#endif // PACKED_H
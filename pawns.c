@@ -0,0 +1,194 @@
+#include "pawns.h"
+#include "attacks.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Slot layout: a check word plus three data words (32 bytes). As in the TT,
+ * the check word is the key XORed with every data word, so an entry torn by
+ * two threads writing at once fails the key comparison and reads as a miss.
+ * An all-zero slot is the correct entry for "no pawns" (key 0, score 0).
+ */
+
+typedef struct
+{
+    _Atomic uint64_t check;     // key ^ scores ^ passed[WHITE] ^ passed[BLACK]
+    _Atomic uint64_t scores;    // mg (low 32 bits) | eg (high 32 bits)
+    _Atomic uint64_t passed[2];
+} PawnSlot;
+
+#define MB (1024 * 1024)
+
+static PawnSlot *table = NULL;
+static size_t slotCount = 0;
+
+// --- Pawn Structure Weights (per pawn, MG / EG) ---
+#define DOUBLED_MG -10
+#define DOUBLED_EG -20
+#define ISOLATED_MG -10
+#define ISOLATED_EG -15
+#define BACKWARD_MG -8
+#define BACKWARD_EG -10
+
+// Passed pawn bonus by ranks advanced from the pawn's own back rank (1 = start square)
+static const int passed_mg[8] = {0, 5, 10, 15, 25, 40, 60, 0};
+static const int passed_eg[8] = {0, 10, 15, 25, 40, 65, 100, 0};
+
+/* ---------- Masks ---------- */
+
+static Bitboard fileMask(int col)
+{
+    return FILE_A_BB << col;
+}
+
+static Bitboard adjacentFiles(int col)
+{
+    return ((col > 0) ? fileMask(col - 1) : 0) | ((col < 7) ? fileMask(col + 1) : 0);
+}
+
+// Rows strictly ahead of 'row' from 'color's point of view (White advances towards row 0)
+static Bitboard rowsAhead(int row, PieceColor color)
+{
+    if (color == WHITE)
+        return BIT(row * 8) - 1;
+    return (row >= 7) ? 0 : ~0ULL << ((row + 1) * 8);
+}
+
+/* ---------- Evaluation ---------- */
+
+static void evaluatePawns(const BoardState *board, PawnEntry *entry)
+{
+    entry->mg = entry->eg = 0;
+    entry->passed[WHITE] = entry->passed[BLACK] = 0;
+
+    for (int color = WHITE; color <= BLACK; color++)
+    {
+        PieceColor them = (color == WHITE) ? BLACK : WHITE;
+        Bitboard own = board->pieceBB[color][PAWN];
+        Bitboard enemy = board->pieceBB[them][PAWN];
+        Bitboard enemyAttacks = pawnSetAttacks(enemy, them);
+        int sign = (color == WHITE) ? 1 : -1;
+        int mg = 0, eg = 0;
+
+        Bitboard pawns = own;
+        while (pawns)
+        {
+            int sq = popLsb(&pawns);
+            int r = SQ_ROW(sq), c = SQ_COL(sq);
+            Bitboard ahead = rowsAhead(r, (PieceColor)color);
+            Bitboard neighbours = adjacentFiles(c) & own;
+
+            // Doubled: another own pawn in front on the same file
+            if (fileMask(c) & ahead & own)
+            {
+                mg += DOUBLED_MG;
+                eg += DOUBLED_EG;
+            }
+
+            if (!neighbours)
+            {
+                // Isolated: no own pawn on either neighbouring file
+                mg += ISOLATED_MG;
+                eg += ISOLATED_EG;
+            }
+            else if (!(neighbours & ~ahead))
+            {
+                // Backward: every neighbour has advanced past it and the
+                // square in front is controlled by an enemy pawn
+                int stop = (color == WHITE) ? sq - 8 : sq + 8;
+                if (stop >= 0 && stop < 64 && (enemyAttacks & BIT(stop)))
+                {
+                    mg += BACKWARD_MG;
+                    eg += BACKWARD_EG;
+                }
+            }
+
+            // Passed: no enemy pawn in front on this or a neighbouring file
+            if (!((fileMask(c) | adjacentFiles(c)) & ahead & enemy))
+            {
+                int advanced = (color == WHITE) ? 7 - r : r;
+                entry->passed[color] |= BIT(sq);
+                mg += passed_mg[advanced];
+                eg += passed_eg[advanced];
+            }
+        }
+
+        entry->mg += sign * mg;
+        entry->eg += sign * eg;
+    }
+}
+
+/* ---------- Public API ---------- */
+
+bool pawnHashInit(size_t megabytes)
+{
+    if (megabytes < 1)
+        megabytes = 1;
+
+    // Largest power of two number of slots that fits the budget
+    size_t slots = 1;
+    while (slots * 2 * sizeof(PawnSlot) <= megabytes * MB)
+        slots *= 2;
+
+    PawnSlot *fresh = aligned_alloc(sizeof(PawnSlot), slots * sizeof(PawnSlot));
+    if (!fresh)
+        return false;
+
+    pawnHashFree();
+    table = fresh;
+    slotCount = slots;
+    pawnHashClear();
+    return true;
+}
+
+void pawnHashFree(void)
+{
+    free(table);
+    table = NULL;
+    slotCount = 0;
+}
+
+void pawnHashClear(void)
+{
+    if (table)
+        memset(table, 0, slotCount * sizeof(PawnSlot));
+}
+
+size_t pawnHashSizeMB(void)
+{
+    return slotCount * sizeof(PawnSlot) / MB;
+}
+
+void probePawns(const BoardState *board, PawnEntry *entry)
+{
+    uint64_t key = board->pawnKey;
+    if (!table)
+    {
+        evaluatePawns(board, entry);
+        return;
+    }
+
+    PawnSlot *slot = &table[key & (slotCount - 1)];
+    uint64_t scores = atomic_load_explicit(&slot->scores, memory_order_relaxed);
+    uint64_t white = atomic_load_explicit(&slot->passed[WHITE], memory_order_relaxed);
+    uint64_t black = atomic_load_explicit(&slot->passed[BLACK], memory_order_relaxed);
+    uint64_t check = atomic_load_explicit(&slot->check, memory_order_relaxed);
+
+    if ((check ^ scores ^ white ^ black) == key)
+    {
+        entry->mg = (int)(int32_t)(uint32_t)scores;
+        entry->eg = (int)(int32_t)(uint32_t)(scores >> 32);
+        entry->passed[WHITE] = white;
+        entry->passed[BLACK] = black;
+        return;
+    }
+
+    evaluatePawns(board, entry);
+    scores = (uint64_t)(uint32_t)entry->mg | ((uint64_t)(uint32_t)entry->eg << 32);
+    atomic_store_explicit(&slot->check, key ^ scores ^ entry->passed[WHITE] ^ entry->passed[BLACK],
+                          memory_order_relaxed);
+    atomic_store_explicit(&slot->scores, scores, memory_order_relaxed);
+    atomic_store_explicit(&slot->passed[WHITE], entry->passed[WHITE], memory_order_relaxed);
+    atomic_store_explicit(&slot->passed[BLACK], entry->passed[BLACK], memory_order_relaxed);
+}
@@ -0,0 +1,53 @@
+#ifndef PAWNS_H
+#define PAWNS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "structs.h"
+
+/*
+ * Pawn structure evaluation.
+ *
+ * Doubled, isolated, backward and passed pawns depend on nothing but the
+ * pawns, so their score is cached in a pawn hash table keyed by
+ * BoardState.pawnKey. Pawn structures repeat far more often than positions,
+ * so almost every call is a table hit. Like the main TT the table is shared
+ * by all search threads without locks; it is sized independently of it.
+ */
+
+#define PAWN_HASH_DEFAULT_MB 4
+
+typedef struct
+{
+    int mg;             // Middlegame pawn structure score (White - Black)
+    int eg;             // Endgame pawn structure score (White - Black)
+    Bitboard passed[2]; // Passed pawns of each color
+} PawnEntry;
+
+/**
+ * @brief Allocates (or resizes) the pawn hash table to at most 'megabytes' MB.
+ * @return false if the memory could not be allocated (previous table kept).
+ */
+bool pawnHashInit(size_t megabytes);
+
+/**
+ * @brief Releases the table. Pawn evaluation still works, just uncached.
+ */
+void pawnHashFree(void);
+
+/**
+ * @brief Empties the table.
+ */
+void pawnHashClear(void);
+
+/**
+ * @brief Size of the allocated table in megabytes.
+ */
+size_t pawnHashSizeMB(void);
+
+/**
+ * @brief Pawn structure terms of the position, from the table or computed and stored.
+ */
+void probePawns(const BoardState *board, PawnEntry *entry);
+
+#endif // PAWNS_H
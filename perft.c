@@ -0,0 +1,151 @@
+/*
+ * ======================================================================================
+ * File: perft.c
+ * Description: Move generator verification and benchmarking (performance test).
+ *
+ * perft(d) is the number of legal move sequences of length d. The reference
+ * counts below are the well-known published values, so any generator change
+ * that alters a count is a bug; the nodes/sec figure measures generator speed.
+ * ======================================================================================
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "perft.h"
+#include "fileio.h"
+#include "game.h"
+#include "movegen.h"
+#include "timer.h"
+
+typedef struct
+{
+    const char *name;
+    const char *fen;
+    int depth;
+    uint64_t expected;
+} PerftCase;
+
+static const PerftCase perftSuite[] = {
+    {"start position", START_FEN, 5, 4865609},
+    {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603},
+    {"position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624},
+    {"position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333},
+    {"position 4 mirrored", "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1", 4, 422333},
+    {"position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487},
+    {"position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594},
+    {"illegal en passant (pin)", "8/8/1k6/8/2pP4/8/5BK1/8 b - d3 0 1", 6, 824064},
+    {"en passant gives check", "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1", 6, 1440467},
+    {"short castle gives check", "5k2/8/8/8/8/8/8/4K2R w K - 0 1", 6, 661072},
+    {"long castle gives check", "3k4/8/8/8/8/8/8/R3K3 w Q - 0 1", 6, 803711},
+    {"castling rights", "r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1", 4, 1274206},
+    {"castling prevented", "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1", 4, 1720476},
+    {"promote out of check", "2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1", 6, 3821001},
+    {"discovered check", "8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1", 5, 1004658},
+    {"promote to give check", "4k3/1P6/8/8/8/8/K7/8 w - - 0 1", 6, 217342},
+    {"underpromote to give check", "8/P1k5/K7/8/8/8/8/8 w - - 0 1", 6, 92683},
+    {"self stalemate", "K1k5/8/P7/8/8/8/8/8 w - - 0 1", 6, 2217},
+    {"stalemate and checkmate 1", "8/k1P5/8/1K6/8/8/8/8 w - - 0 1", 7, 567584},
+    {"stalemate and checkmate 2", "8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1", 4, 23527},
+};
+
+#define PERFT_SUITE_SIZE (int)(sizeof(perftSuite) / sizeof(perftSuite[0]))
+
+uint64_t perft(BoardState *board, int depth)
+{
+    if (depth <= 0)
+        return 1;
+
+    Move moves[MAX_MOVES_IN_LIST];
+    int count = generateLegalMoves(board, moves);
+
+    // Bulk counting: every legal move at the last ply is exactly one leaf
+    if (depth == 1)
+        return (uint64_t)count;
+
+    uint64_t nodes = 0;
+    for (int i = 0; i < count; i++)
+    {
+        MoveRecord undo;
+        makeMove(board, moves[i], &undo);
+        nodes += perft(board, depth - 1);
+        undoMove(board, &undo);
+    }
+    return nodes;
+}
+
+static double nodesPerSecond(uint64_t nodes, int64_t ms)
+{
+    return (ms > 0) ? (double)nodes * 1000.0 / (double)ms : 0.0;
+}
+
+uint64_t divide(BoardState *board, int depth)
+{
+    int64_t start = nowMs();
+    uint64_t total = 0;
+
+    MoveList moves;
+    generateAllLegalMoves(board, &moves);
+    for (int i = 0; i < moves.count; i++)
+    {
+        char text[6];
+        uint64_t nodes = 1;
+
+        if (depth > 1)
+        {
+            MoveRecord undo;
+            makeMove(board, moves.moves[i], &undo);
+            nodes = perft(board, depth - 1);
+            undoMove(board, &undo);
+        }
+        total += nodes;
+
+        moveToString(moves.moves[i], text);
+        printf("%s: %llu\n", text, (unsigned long long)nodes);
+    }
+
+    int64_t elapsed = nowMs() - start;
+    printf("\nMoves: %d\nNodes: %llu\nTime: %lld ms (%.0f nodes/sec)\n", moves.count,
+           (unsigned long long)total, (long long)elapsed, nodesPerSecond(total, elapsed));
+    return total;
+}
+
+int runPerftSuite(void)
+{
+    int failures = 0;
+    uint64_t totalNodes = 0;
+    int64_t totalTime = 0;
+
+    for (int i = 0; i < PERFT_SUITE_SIZE; i++)
+    {
+        const PerftCase *test = &perftSuite[i];
+        BoardState board;
+
+        if (!loadBoardFromFEN(test->fen, &board))
+        {
+            printf("FAIL %-28s invalid FEN\n", test->name);
+            failures++;
+            continue;
+        }
+
+        int64_t start = nowMs();
+        uint64_t nodes = perft(&board, test->depth);
+        int64_t elapsed = nowMs() - start;
+
+        bool ok = (nodes == test->expected);
+        if (!ok)
+            failures++;
+        totalNodes += nodes;
+        totalTime += elapsed;
+
+        printf("%s %-28s depth %d: %12llu", ok ? "ok  " : "FAIL", test->name, test->depth, (unsigned long long)nodes);
+        if (!ok)
+            printf(" (expected %llu)", (unsigned long long)test->expected);
+        printf("  %6lld ms  %10.0f nps\n", (long long)elapsed, nodesPerSecond(nodes, elapsed));
+    }
+
+    printf("\n%d/%d positions passed, %llu nodes in %lld ms (%.0f nodes/sec)\n", PERFT_SUITE_SIZE - failures,
+           PERFT_SUITE_SIZE, (unsigned long long)totalNodes, (long long)totalTime,
+           nodesPerSecond(totalNodes, totalTime));
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,26 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include <stdint.h>
+#include "structs.h"
+
+/**
+ * @brief Counts the leaf nodes of the legal move tree to 'depth' plies.
+ * The last ply is bulk-counted: the size of the legal move list is used
+ * directly instead of making each move.
+ */
+uint64_t perft(BoardState *board, int depth);
+
+/**
+ * @brief Prints the perft count below every root move, then the total and nodes/sec.
+ * Comparing this per-move split against a reference engine pinpoints generator bugs.
+ */
+uint64_t divide(BoardState *board, int depth);
+
+/**
+ * @brief Runs the built-in reference positions and checks every count.
+ * @return 0 if every position matched its expected count, 1 otherwise.
+ */
+int runPerftSuite(void);
+
+#endif // PERFT_H
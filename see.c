@@ -0,0 +1,80 @@
+#include "see.h"
+#include "attacks.h"
+
+const int seeValue[7] = {0, 100, 320, 330, 500, 900, 20000};
+
+// Longest possible exchange: every piece on the board takes part once
+#define MAX_EXCHANGE 32
+
+/* Least valuable piece of 'color' in 'attackers' (EMPTY if there is none) */
+static PieceType leastValuable(const BoardState *board, Bitboard attackers, PieceColor color, Bitboard *fromSet)
+{
+    for (PieceType type = PAWN; type <= KING; type++)
+    {
+        Bitboard subset = attackers & board->pieceBB[color][type];
+        if (subset)
+        {
+            *fromSet = subset & -subset;
+            return type;
+        }
+    }
+    return EMPTY;
+}
+
+int see(const BoardState *board, Move move)
+{
+    int gain[MAX_EXCHANGE];
+    int to = move.to;
+    PieceColor side = board->currentPlayer;
+    PieceType attacker = board->squares[SQ_ROW(move.from)][SQ_COL(move.from)].type;
+    PieceType captured = board->squares[SQ_ROW(to)][SQ_COL(to)].type;
+    Bitboard occupied = board->occupiedBB;
+    Bitboard fromSet = BIT(move.from);
+
+    // The pawn taken en passant is not on the destination square
+    if (move.flag == MOVE_EN_PASSANT)
+    {
+        captured = PAWN;
+        occupied ^= BIT((side == WHITE) ? to + 8 : to - 8);
+    }
+
+    gain[0] = seeValue[captured];
+    if (move.flag == MOVE_PROMOTION)
+    {
+        gain[0] += seeValue[move.promotion] - seeValue[PAWN];
+        attacker = move.promotion;
+    }
+
+    Bitboard diagonal = board->pieceBB[WHITE][BISHOP] | board->pieceBB[BLACK][BISHOP] |
+                        board->pieceBB[WHITE][QUEEN] | board->pieceBB[BLACK][QUEEN];
+    Bitboard straight = board->pieceBB[WHITE][ROOK] | board->pieceBB[BLACK][ROOK] |
+                        board->pieceBB[WHITE][QUEEN] | board->pieceBB[BLACK][QUEEN];
+    Bitboard attackers = attackersTo(board, to, occupied);
+
+    // gain[d]: material balance for the side making capture d if the exchange stopped there
+    int d = 0;
+    while (d + 1 < MAX_EXCHANGE)
+    {
+        d++;
+        gain[d] = seeValue[attacker] - gain[d - 1];
+
+        // Neither side can profit from going on
+        if ((-gain[d - 1] > gain[d] ? -gain[d - 1] : gain[d]) < 0)
+            break;
+
+        // Remove the piece that just captured; uncover sliders behind it
+        occupied ^= fromSet;
+        attackers |= (bishopAttacks(to, occupied) & diagonal) | (rookAttacks(to, occupied) & straight);
+        attackers &= occupied;
+
+        side = (side == WHITE) ? BLACK : WHITE;
+        attacker = leastValuable(board, attackers, side, &fromSet);
+        if (attacker == EMPTY)
+            break;
+    }
+
+    // Negamax the balances back: each side may decline to continue the exchange
+    while (--d)
+        gain[d - 1] = -(-gain[d - 1] > gain[d] ? -gain[d - 1] : gain[d]);
+    return gain[0];
+}
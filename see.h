@@ -0,0 +1,26 @@
+#ifndef SEE_H
+#define SEE_H
+
+#include "structs.h"
+
+/*
+ * Static exchange evaluation.
+ *
+ * Plays out every capture on the destination square of a move, each side
+ * always recapturing with its least valuable attacker and stopping as soon
+ * as continuing would lose material. Sliders hidden behind a piece that
+ * captured (x-rays) join in once the piece has left. Pins and checks are
+ * ignored, so the result is an estimate, but it needs no makeMove() and
+ * tells an obviously losing capture (QxP defended by a pawn) from a good one.
+ */
+
+/* Exchange values by PieceType */
+extern const int seeValue[7];
+
+/**
+ * @brief Material the side to move wins (negative: loses) by playing 'move'
+ * and the best sequence of recaptures on its destination square.
+ */
+int see(const BoardState *board, Move move);
+
+#endif // SEE_H
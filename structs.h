@@ -1,7 +1,10 @@
 #ifndef STRUCTS_H
 #define STRUCTS_H
 
-#define MAX_MOVES_IN_LIST 512
+#include "bitboard.h"
+
+// No legal position has more than 218 moves
+#define MAX_MOVES_IN_LIST 256
 
 // --- Piece / Color ---
 
@@ -47,14 +50,20 @@ typedef struct
 
 // --- Move Struct ---
 
+// Packed into 32 bits so move lists stay small and cheap to copy.
+// Squares use the bitboard numbering (see bitboard.h).
 typedef struct
 {
-    Position from;
-    Position to;
-    PieceType promotion; // For promotion moves; otherwise EMPTY
-    int flag;            // MOVE_* constants
+    uint8_t from;      // Square index 0..63
+    uint8_t to;        // Square index 0..63
+    uint8_t promotion; // PieceType for promotion moves; otherwise EMPTY
+    uint8_t flag;      // MOVE_* constants
 } Move;
 
+// A move from a square to itself never occurs, so it marks "no move"
+#define NO_MOVE ((Move){0, 0, EMPTY, MOVE_NORMAL})
+#define IS_NO_MOVE(m) ((m).from == (m).to)
+
 // --- Move List ---
 
 typedef struct
@@ -73,19 +82,72 @@ typedef struct
     int bq; // black queen-side
 } CastlingRights;
 
+// --- NNUE Accumulator ---
+
+#define NNUE_HIDDEN 256 // First-layer neurons per perspective
+
+// First layer of the evaluation network for both perspectives (see nnue.h)
+typedef struct
+{
+    int16_t values[2][NNUE_HIDDEN]; // [perspective color] weighted feature sums plus bias
+    int kingKey[2];                 // King bucket the sums were built for; -1 when stale
+    uint32_t network;               // Network the sums were built with (see nnueInit)
+} NNUEAccumulator;
+
 // --- Board State ---
 
+#define KEY_HISTORY_SIZE 256 // Power of two, above the 100 plies the 50-move rule allows
+
 typedef struct
 {
-    Piece squares[8][8];      // Board representation
+    Piece squares[8][8];      // Mailbox: piece lookup by square
     PieceColor currentPlayer; // Side to move
 
+    // Bitboards (see bitboard.h for square numbering), kept in sync with
+    // squares[][] by makeMove/undoMove and rebuilt by refreshBoardState().
+    Bitboard pieceBB[2][7]; // [color][PieceType]; the EMPTY slot is unused
+    Bitboard colorBB[2];    // All pieces of one color
+    Bitboard occupiedBB;    // Every occupied square
+    int kingSq[2];          // Square of each color's king, -1 if it has none
+
     CastlingRights castling; // Current castling rights
 
     Position enPassantTarget; // Square behind pawn that moved 2 squares (or -1,-1)
 
     int halfmoveClock;  // For 50-move rule
     int fullmoveNumber; // Counts moves starting from 1
+
+    // Keys of the positions before each move played (game and search alike),
+    // for repetition detection. Only the last halfmoveClock entries can repeat,
+    // so a ring buffer longer than the 50-move window is enough.
+    uint64_t keyHistory[KEY_HISTORY_SIZE];
+    int historyLength; // Moves played since the position was set up
+
+    uint64_t hash;    // Zobrist key of the position (see zobrist.h)
+    uint64_t pawnKey; // Zobrist key of the pawns alone (pawn hash table, see pawns.h)
+
+    // Static evaluation terms kept up to date by makeMove/undoMove (see eval.h)
+    int psqMg; // Material + piece-square sum, middlegame weights (White - Black)
+    int psqEg; // Same with endgame weights
+    int phase; // Game phase: 24 with every piece on the board, 0 with none
+
+    NNUEAccumulator nnue; // Kept up to date by makeMove/undoMove while a network is loaded
 } BoardState;
 
+// --- Undo Record ---
+
+// Everything makeMove() changes that undoMove() cannot derive from the move.
+// Owned by the caller: one per ply of a search, undone in reverse order.
+typedef struct
+{
+    Move move;
+    Piece captured;
+    CastlingRights prevCastling;
+    Position prevEnPassant;
+    int prevHalfmoveClock;
+    int prevFullmoveNumber;
+    PieceColor prevPlayer;
+    uint64_t prevHash;
+} MoveRecord;
+
 #endif
@@ -0,0 +1,1297 @@
+// mmap(), opendir() and friends are POSIX, not ISO C
+#define _POSIX_C_SOURCE 200809L
+
+#include "syzygy.h"
+#include "bitboard.h"
+#include "fileio.h"
+#include "game.h"
+#include "movegen.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TB_HAVE_MMAP 1
+#endif
+
+/*
+ * Every file starts with a 4-byte magic number and a flags byte, followed
+ * by the layout of its sub-tables and their compressed data. Files are
+ * registered under their material signature ("KRPvKR": white-or-stronger
+ * side first, pieces in KQRBNP order), which is also how a position finds
+ * its table.
+ *
+ * A sub-table holds one value per index for one side to move (WDL files)
+ * or one file of the leading pawn (tables with pawns). Values are stored
+ * as a stream of symbols, each of which expands to a run of values
+ * through a binary tree of symbol pairs; the symbols are Huffman coded in
+ * fixed-size blocks, and a sparse index gives the block holding every
+ * 'span'-th value so a probe decodes at most part of one block.
+ */
+
+static const uint8_t WDL_MAGIC[4] = {0x71, 0xe8, 0x23, 0x5d};
+static const uint8_t DTZ_MAGIC[4] = {0xd7, 0x66, 0x0c, 0xa5};
+
+// Longest signature: 7 pieces, the 'v' and the terminator
+#define TB_NAME_LENGTH (TB_MAX_PIECES + 2)
+
+// File header flags
+#define TB_FILE_SPLIT 1     // Two sides to move stored (WDL of non-symmetric material)
+#define TB_FILE_HAS_PAWNS 2 // One sub-table per file of the leading pawn
+
+// Sub-table flags
+#define TB_STM 1            // DTZ: side to move stored (0 White, 1 Black)
+#define TB_MAPPED 2         // DTZ: values go through a map per WDL outcome
+#define TB_WIN_PLIES 4      // DTZ: wins stored in plies rather than moves
+#define TB_LOSS_PLIES 8     // DTZ: losses stored in plies rather than moves
+#define TB_WIDE 16          // DTZ: 16-bit map entries
+#define TB_SINGLE_VALUE 128 // Every index has the same value, no data follows
+
+// Piece codes of the file format: type, plus 8 for the side listed second
+#define TB_BLACK 8
+
+typedef struct
+{
+    uint8_t flags;                        // TB_STM ... TB_SINGLE_VALUE
+    uint8_t pieces[TB_MAX_PIECES];        // Piece codes in encoding order
+    uint8_t groupLen[TB_MAX_PIECES + 1];  // Runs of pieces encoded together, 0-terminated
+    uint64_t groupIdx[TB_MAX_PIECES + 1]; // Index weight of each group; after the last, the table size
+    const uint8_t *sparseIndex;           // Per span: block (u32) and value offset in it (u16)
+    size_t sparseIndexSize;
+    const uint8_t *blockLength; // Per block: values in it minus one (u16)
+    size_t blockLengthSize;
+    const uint8_t *data; // Compressed blocks
+    const uint8_t *end;  // End of the file
+    uint64_t blockSize;
+    uint64_t span;
+    uint32_t numBlocks;
+    int minSymLen; // The value itself for TB_SINGLE_VALUE
+    int maxSymLen;
+    const uint8_t *lowestSym; // Per code length: first symbol with that length (u16)
+    uint64_t *base64;         // Per code length: its smallest code, left-aligned
+    uint8_t *symlen;          // Per symbol: values it expands to, minus one
+    const uint8_t *btree;     // Per symbol: left and right child, 12 bits each
+    int symbols;
+    int mapIdx[4]; // DTZ with TB_MAPPED: where the map of each WDL outcome starts
+} PairsData;
+
+typedef struct
+{
+    char name[TB_NAME_LENGTH];
+    int pieces;
+    const uint8_t *wdl; // Mapped .rtbw file (NULL if absent or unreadable)
+    size_t wdlSize;
+    const uint8_t *dtz; // Mapped .rtbz file (NULL if absent or unreadable)
+    size_t dtzSize;
+
+    // Encoding of the material, derived from the name
+    bool hasPawns;
+    bool uniquePieces; // Some side has exactly one piece of a type other than king
+    bool symmetric;    // Both sides have the same material
+    int pawnCount[2];  // Leading pawns (the side with fewer), then the other side's
+
+    PairsData wdlPairs[2][4]; // [side to move][file of the leading pawn]
+    PairsData dtzPairs[4];    // [file of the leading pawn]
+    const uint8_t *dtzMap;
+    size_t dtzMapSize;
+} TBTable;
+
+static TBTable *tables = NULL; // Sorted by name once loading is done
+static int tableCount = 0;
+static int largest = 0;
+
+/* ---------- Material Signatures ---------- */
+
+static const char pieceLetters[] = "KQRBNP";
+static const PieceType letterTypes[] = {KING, QUEEN, ROOK, BISHOP, KNIGHT, PAWN};
+
+/* Signature of the position with 'first' as the side written first */
+static void materialName(const BoardState *board, PieceColor first, char *out)
+{
+    PieceColor order[2] = {first, (first == WHITE) ? BLACK : WHITE};
+    int length = 0;
+    for (int side = 0; side < 2; side++)
+    {
+        if (side == 1)
+            out[length++] = 'v';
+        for (int i = 0; i < 6; i++)
+            for (int n = popCount(board->pieceBB[order[side]][letterTypes[i]]); n > 0 && length < TB_NAME_LENGTH - 1;
+                 n--)
+                out[length++] = pieceLetters[i];
+    }
+    out[length] = '\0';
+}
+
+/* Piece count of a file stem such as "KQvK", or 0 if it is not a table name */
+static int parseTableName(const char *stem)
+{
+    int pieces = 0, separators = 0;
+    for (const char *c = stem; *c; c++)
+    {
+        if (*c == 'v')
+            separators++;
+        else if (strchr(pieceLetters, *c))
+            pieces++;
+        else
+            return 0;
+    }
+    return (separators == 1 && pieces >= 3 && pieces <= TB_MAX_PIECES) ? pieces : 0;
+}
+
+static int compareTables(const void *a, const void *b)
+{
+    return strcmp(((const TBTable *)a)->name, ((const TBTable *)b)->name);
+}
+
+static TBTable *findTable(const char *name)
+{
+    TBTable key;
+    strncpy(key.name, name, sizeof(key.name) - 1);
+    key.name[sizeof(key.name) - 1] = '\0';
+    return tables ? bsearch(&key, tables, (size_t)tableCount, sizeof(TBTable), compareTables) : NULL;
+}
+
+/* Table of the position; 'flipped' tells whether Black is the side listed first */
+static const TBTable *tableFor(const BoardState *board, bool *flipped)
+{
+    char name[TB_NAME_LENGTH];
+    materialName(board, WHITE, name);
+    const TBTable *table = findTable(name);
+    *flipped = false;
+    if (!table)
+    {
+        materialName(board, BLACK, name);
+        table = findTable(name);
+        *flipped = true;
+    }
+    return table;
+}
+
+/* ---------- Index Tables ---------- */
+
+/*
+ * Squares here are the file format's: a1 = 0 ... h8 = 63, i.e. the
+ * engine's square ^ 56. Pawnless positions are first brought into the
+ * a1-d1-d4 triangle by the board's symmetries; positions with pawns can
+ * only be mirrored left-right and use the a-d files for the leading pawn.
+ */
+
+#define TB_RANK(sq) ((sq) >> 3)
+#define TB_FILE(sq) ((sq) & 7)
+#define TB_OFF_DIAGONAL(sq) (TB_RANK(sq) - TB_FILE(sq)) // > 0 above the a1-h8 diagonal
+
+static uint64_t binomial[TB_MAX_PIECES][64];     // binomial[k][n]: ways to pick k of n
+static int mapPawns[64];                         // Pawn squares numbered from the edge files inwards
+static uint64_t leadPawnIdx[TB_MAX_PIECES][64];  // [leading pawns][square of the first one]
+static uint64_t leadPawnsSize[TB_MAX_PIECES][4]; // [leading pawns][file of the first one]
+static int mapB1H1H7[64];                        // Squares below the diagonal, 0..27
+static int mapA1D1D4[64];                        // The a1-d1-d4 triangle, diagonal last, 0..9
+static int mapKK[10][64];                        // Both kings of a pawnless table, 0..461
+static bool indexTablesReady = false;
+
+static void initIndexTables(void)
+{
+    if (indexTablesReady)
+        return;
+
+    int code = 0;
+    for (int sq = 0; sq < 64; sq++)
+        if (TB_OFF_DIAGONAL(sq) < 0)
+            mapB1H1H7[sq] = code++;
+
+    // Squares of a1-d4 below the diagonal first, then the diagonal ones
+    int diagonal[4], diagonalCount = 0;
+    code = 0;
+    for (int sq = 0; sq <= 27; sq++)
+    {
+        if (TB_OFF_DIAGONAL(sq) < 0 && TB_FILE(sq) <= 3)
+            mapA1D1D4[sq] = code++;
+        else if (!TB_OFF_DIAGONAL(sq) && TB_FILE(sq) <= 3)
+            diagonal[diagonalCount++] = sq;
+    }
+    for (int i = 0; i < diagonalCount; i++)
+        mapA1D1D4[diagonal[i]] = code++;
+
+    // Legal king pairs with the first king in the triangle; with it on the
+    // diagonal the second one stays on or below it. Pairs with both kings
+    // on the diagonal come last.
+    int bothOnDiagonal[10 * 64][2], bothCount = 0;
+    code = 0;
+    for (int idx = 0; idx < 10; idx++)
+        for (int s1 = 0; s1 <= 27; s1++)
+        {
+            // Squares outside the triangle map to 0 too; b1 is the real code 0
+            if (mapA1D1D4[s1] != idx || (idx == 0 && s1 != 1))
+                continue;
+            for (int s2 = 0; s2 < 64; s2++)
+            {
+                int rankDistance = abs(TB_RANK(s1) - TB_RANK(s2));
+                int fileDistance = abs(TB_FILE(s1) - TB_FILE(s2));
+                if (rankDistance <= 1 && fileDistance <= 1)
+                    continue; // Same or adjacent squares
+                if (!TB_OFF_DIAGONAL(s1) && TB_OFF_DIAGONAL(s2) > 0)
+                    continue;
+                if (!TB_OFF_DIAGONAL(s1) && !TB_OFF_DIAGONAL(s2))
+                {
+                    bothOnDiagonal[bothCount][0] = idx;
+                    bothOnDiagonal[bothCount++][1] = s2;
+                }
+                else
+                    mapKK[idx][s2] = code++;
+            }
+        }
+    for (int i = 0; i < bothCount; i++)
+        mapKK[bothOnDiagonal[i][0]][bothOnDiagonal[i][1]] = code++;
+
+    binomial[0][0] = 1;
+    for (int n = 1; n < 64; n++)
+        for (int k = 0; k < TB_MAX_PIECES && k <= n; k++)
+            binomial[k][n] = (k > 0 ? binomial[k - 1][n - 1] : 0) + (k < n ? binomial[k][n - 1] : 0);
+
+    // Pawn squares of ranks 2-7, numbered 47 down to 0 from the edge files
+    // inwards; every leading-pawn configuration of one file gets a block
+    // of indices, the first pawn determining where it starts.
+    for (int count = 1; count <= 5; count++)
+    {
+        int available = 47;
+        for (int file = 0; file < 4; file++)
+        {
+            uint64_t idx = 0;
+            for (int rank = 1; rank <= 6; rank++)
+            {
+                int sq = rank * 8 + file;
+                if (count == 1)
+                {
+                    mapPawns[sq] = available--;
+                    mapPawns[sq ^ 7] = available--;
+                }
+                leadPawnIdx[count][sq] = idx;
+                idx += binomial[count - 1][mapPawns[sq]];
+            }
+            leadPawnsSize[count][file] = idx;
+        }
+    }
+    indexTablesReady = true;
+}
+
+/* ---------- Header Parsing ---------- */
+
+static uint16_t readU16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static uint32_t readU32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/* Big-endian word of a block; bytes past the end of the file read as 0 */
+static uint32_t readBlockWord(const uint8_t *p, const uint8_t *end)
+{
+    uint32_t word = 0;
+    for (int i = 0; i < 4; i++)
+        word = word << 8 | (p + i < end ? p[i] : 0);
+    return word;
+}
+
+static int leftChild(const PairsData *d, int sym)
+{
+    const uint8_t *lr = d->btree + 3 * sym;
+    return (lr[1] & 0xF) << 8 | lr[0];
+}
+
+static int rightChild(const PairsData *d, int sym)
+{
+    const uint8_t *lr = d->btree + 3 * sym;
+    return lr[2] << 4 | lr[1] >> 4;
+}
+
+/* Encoding properties of the material, from the table name */
+static void setMaterial(TBTable *table)
+{
+    int counts[2][7] = {{0}};
+    int side = 0;
+    for (const char *c = table->name; *c; c++)
+    {
+        if (*c == 'v')
+            side = 1;
+        else
+            counts[side][letterTypes[strchr(pieceLetters, *c) - pieceLetters]]++;
+    }
+    const char *separator = strchr(table->name, 'v');
+    size_t strongLength = (size_t)(separator - table->name);
+    table->symmetric = strlen(separator + 1) == strongLength && !strncmp(separator + 1, table->name, strongLength);
+    table->hasPawns = counts[0][PAWN] || counts[1][PAWN];
+    table->uniquePieces = false;
+    for (int c = 0; c < 2; c++)
+        for (int type = PAWN; type < KING; type++)
+            if (counts[c][type] == 1)
+                table->uniquePieces = true;
+
+    // The side with fewer pawns leads, White on equal counts
+    bool whiteLeads = !counts[1][PAWN] || (counts[0][PAWN] && counts[1][PAWN] >= counts[0][PAWN]);
+    table->pawnCount[0] = counts[whiteLeads ? 0 : 1][PAWN];
+    table->pawnCount[1] = counts[whiteLeads ? 1 : 0][PAWN];
+}
+
+/* Splits the pieces into the groups encoded together and weights each group's index */
+static bool setGroups(const TBTable *table, PairsData *d, const int order[2], int file)
+{
+    int n = 0;
+    int firstLen = table->hasPawns ? 0 : table->uniquePieces ? 3 : 2;
+    d->groupLen[n] = 1;
+    for (int i = 1; i < table->pieces; i++)
+    {
+        if (--firstLen > 0 || d->pieces[i] == d->pieces[i - 1])
+            d->groupLen[n]++;
+        else
+            d->groupLen[++n] = 1;
+    }
+    d->groupLen[++n] = 0;
+
+    bool bothPawns = table->hasPawns && table->pawnCount[1];
+    int next = bothPawns ? 2 : 1;
+    int freeSquares = 64 - d->groupLen[0] - (bothPawns ? d->groupLen[1] : 0);
+    uint64_t idx = 1;
+    for (int k = 0; next < n || k == order[0] || k == order[1]; k++)
+    {
+        if (k == order[0])
+        {
+            d->groupIdx[0] = idx;
+            idx *= table->hasPawns ? leadPawnsSize[d->groupLen[0]][file] : table->uniquePieces ? 31332 : 462;
+        }
+        else if (k == order[1])
+        {
+            d->groupIdx[1] = idx;
+            idx *= binomial[d->groupLen[1]][48 - d->groupLen[0]];
+        }
+        else
+        {
+            d->groupIdx[next] = idx;
+            idx *= binomial[d->groupLen[next]][freeSquares];
+            freeSquares -= d->groupLen[next++];
+        }
+    }
+    d->groupIdx[n] = idx;
+
+    for (int i = 0; i <= n; i++)
+        if (!d->groupIdx[i])
+            return false;
+    return true;
+}
+
+/* Longest run of values the symbol expands to */
+static bool setSymlen(PairsData *d, int sym, uint8_t *visited)
+{
+    visited[sym] = 1;
+    int right = rightChild(d, sym);
+    if (right == 0xFFF)
+    {
+        d->symlen[sym] = 0;
+        return true;
+    }
+    int left = leftChild(d, sym);
+    if (left >= d->symbols || right >= d->symbols)
+        return false;
+    if (!visited[left] && !setSymlen(d, left, visited))
+        return false;
+    if (!visited[right] && !setSymlen(d, right, visited))
+        return false;
+    d->symlen[sym] = (uint8_t)(d->symlen[left] + d->symlen[right] + 1);
+    return true;
+}
+
+/* Block layout and Huffman code of one sub-table; NULL if the header is cut short */
+static const uint8_t *setSizes(PairsData *d, const uint8_t *p, const uint8_t *end)
+{
+    if (end - p < 2)
+        return NULL;
+    d->flags = *p++;
+    if (d->flags & TB_SINGLE_VALUE)
+    {
+        d->minSymLen = *p++;
+        return p;
+    }
+
+    int groups = 0;
+    while (d->groupLen[groups])
+        groups++;
+    uint64_t tbSize = d->groupIdx[groups];
+
+    if (end - p < 9)
+        return NULL;
+    if (p[0] > 30 || p[1] > 30)
+        return NULL;
+    d->blockSize = 1ULL << p[0];
+    d->span = 1ULL << p[1];
+    d->sparseIndexSize = (size_t)((tbSize + d->span - 1) / d->span);
+    int padding = p[2];
+    d->numBlocks = readU32(p + 3);
+    d->blockLengthSize = (size_t)d->numBlocks + (size_t)padding;
+    d->maxSymLen = p[7];
+    d->minSymLen = p[8];
+    p += 9;
+    if (d->minSymLen < 1 || d->maxSymLen < d->minSymLen || d->maxSymLen > 32)
+        return NULL;
+
+    int lengths = d->maxSymLen - d->minSymLen + 1;
+    if (end - p < 2 * lengths + 2)
+        return NULL;
+    d->lowestSym = p;
+    d->base64 = malloc(sizeof(uint64_t) * (size_t)lengths);
+    if (!d->base64)
+        return NULL;
+    d->base64[lengths - 1] = 0;
+    for (int i = lengths - 2; i >= 0; i--)
+        d->base64[i] = (d->base64[i + 1] + readU16(p + 2 * i) - readU16(p + 2 * (i + 1))) / 2;
+    for (int i = 0; i < lengths; i++)
+        d->base64[i] <<= 64 - i - d->minSymLen;
+    p += 2 * lengths;
+
+    d->symbols = readU16(p);
+    p += 2;
+    if (end - p < 3 * d->symbols + (d->symbols & 1))
+        return NULL;
+    d->btree = p;
+    d->symlen = calloc((size_t)d->symbols + 1, 1);
+    uint8_t *visited = calloc((size_t)d->symbols + 1, 1);
+    bool ok = d->symlen && visited;
+    for (int sym = 0; ok && sym < d->symbols; sym++)
+        if (!visited[sym])
+            ok = setSymlen(d, sym, visited);
+    free(visited);
+
+    // A cycle in a damaged tree leaves lengths that do not add up; decoding
+    // relies on every pair being longer than its children
+    for (int sym = 0; ok && sym < d->symbols; sym++)
+        if (rightChild(d, sym) != 0xFFF)
+            ok = d->symlen[sym] == d->symlen[leftChild(d, sym)] + d->symlen[rightChild(d, sym)] + 1;
+    if (!ok)
+        return NULL;
+    return p + 3 * d->symbols + (d->symbols & 1);
+}
+
+/* Value maps of a DTZ table */
+static const uint8_t *setDtzMap(TBTable *table, const uint8_t *file, const uint8_t *p, const uint8_t *end, int files)
+{
+    table->dtzMap = p;
+    for (int f = 0; f < files; f++)
+    {
+        PairsData *d = &table->dtzPairs[f];
+        if (!(d->flags & TB_MAPPED))
+            continue;
+        if (d->flags & TB_WIDE)
+        {
+            p += (p - file) & 1; // 16-bit entries are word aligned
+            for (int i = 0; i < 4; i++)
+            {
+                if (end - p < 2)
+                    return NULL;
+                d->mapIdx[i] = (int)((p - table->dtzMap) / 2) + 1;
+                p += 2 * readU16(p) + 2;
+            }
+        }
+        else
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                if (end - p < 1)
+                    return NULL;
+                d->mapIdx[i] = (int)(p - table->dtzMap) + 1;
+                p += *p + 1;
+            }
+        }
+    }
+    if (p > end)
+        return NULL;
+    table->dtzMapSize = (size_t)(p - table->dtzMap);
+    return p + ((p - file) & 1);
+}
+
+static void freePairs(PairsData *d)
+{
+    free(d->base64);
+    free(d->symlen);
+    d->base64 = NULL;
+    d->symlen = NULL;
+}
+
+static void freeTable(TBTable *table, bool dtz)
+{
+    if (dtz)
+        for (int f = 0; f < 4; f++)
+            freePairs(&table->dtzPairs[f]);
+    else
+        for (int i = 0; i < 2; i++)
+            for (int f = 0; f < 4; f++)
+                freePairs(&table->wdlPairs[i][f]);
+}
+
+/* Reads the layout of a mapped file into the table; false if it does not fit the material */
+static bool parseTable(TBTable *table, bool dtz)
+{
+    const uint8_t *file = dtz ? table->dtz : table->wdl;
+    const uint8_t *end = file + (dtz ? table->dtzSize : table->wdlSize);
+    const uint8_t *p = file + 4;
+    if (p >= end)
+        return false;
+
+    uint8_t flags = *p++;
+    if (!(flags & TB_FILE_HAS_PAWNS) != !table->hasPawns || !(flags & TB_FILE_SPLIT) != table->symmetric)
+        return false;
+
+    int files = table->hasPawns ? 4 : 1;
+    int sides = (!dtz && !table->symmetric) ? 2 : 1;
+    bool bothPawns = table->hasPawns && table->pawnCount[1];
+    PairsData *pairs[2][4];
+    for (int i = 0; i < 2; i++)
+        for (int f = 0; f < 4; f++)
+            pairs[i][f] = dtz ? &table->dtzPairs[f] : &table->wdlPairs[i][f];
+
+    for (int f = 0; f < files; f++)
+    {
+        if (end - p < 1 + bothPawns + table->pieces)
+            return false;
+        int order[2][2] = {{p[0] & 0xF, bothPawns ? p[1] & 0xF : 0xF}, {p[0] >> 4, bothPawns ? p[1] >> 4 : 0xF}};
+        p += 1 + bothPawns;
+        for (int k = 0; k < table->pieces; k++, p++)
+            for (int i = 0; i < sides; i++)
+                pairs[i][f]->pieces[k] = (uint8_t)(i ? *p >> 4 : *p & 0xF);
+        for (int i = 0; i < sides; i++)
+            if (!setGroups(table, pairs[i][f], order[i], f))
+                return false;
+    }
+    p += (p - file) & 1;
+
+    for (int f = 0; f < files; f++)
+        for (int i = 0; i < sides; i++)
+            if (!(p = setSizes(pairs[i][f], p, end)))
+                return false;
+    if (dtz && !(p = setDtzMap(table, file, p, end, files)))
+        return false;
+
+    // Offsets only from here on; one check at the end covers them all. The
+    // alignment of empty data (single-value sub-tables) may point past the end.
+    size_t offset = (size_t)(p - file);
+    for (int f = 0; f < files; f++)
+        for (int i = 0; i < sides; i++)
+        {
+            pairs[i][f]->sparseIndex = file + offset;
+            offset += pairs[i][f]->sparseIndexSize * 6;
+        }
+    for (int f = 0; f < files; f++)
+        for (int i = 0; i < sides; i++)
+        {
+            pairs[i][f]->blockLength = file + offset;
+            offset += pairs[i][f]->blockLengthSize * 2;
+        }
+    size_t required = offset;
+    for (int f = 0; f < files; f++)
+        for (int i = 0; i < sides; i++)
+        {
+            offset = (offset + 63) & ~(size_t)63;
+            pairs[i][f]->data = file + offset;
+            pairs[i][f]->end = end;
+            offset += (size_t)pairs[i][f]->numBlocks * pairs[i][f]->blockSize;
+            if (pairs[i][f]->numBlocks)
+                required = offset;
+        }
+    return required <= (size_t)(end - file);
+}
+
+/* ---------- Decoding ---------- */
+
+/* Value number 'idx' of a sub-table; -1 if the data is inconsistent */
+static int decompressPairs(const PairsData *d, uint64_t idx)
+{
+    if (d->flags & TB_SINGLE_VALUE)
+        return d->minSymLen;
+
+    uint64_t k = idx / d->span;
+    if (k >= d->sparseIndexSize)
+        return -1;
+    uint32_t block = readU32(d->sparseIndex + 6 * k);
+    int offset = readU16(d->sparseIndex + 6 * k + 4);
+    if (block >= d->blockLengthSize)
+        return -1;
+
+    // The sparse entry points at the middle of its span; walk to our value
+    offset += (int)(idx % d->span) - (int)(d->span / 2);
+    while (offset < 0)
+    {
+        if (block == 0)
+            return -1;
+        offset += readU16(d->blockLength + 2 * --block) + 1;
+    }
+    while (block < d->blockLengthSize && offset > readU16(d->blockLength + 2 * block))
+        offset -= readU16(d->blockLength + 2 * block++) + 1;
+    if (block >= d->numBlocks)
+        return -1;
+
+    // Canonical Huffman codes, read MSB first: a code of length min + len is
+    // at least base64[len], and the symbols of one length are consecutive
+    const uint8_t *ptr = d->data + block * d->blockSize;
+    uint64_t buf64 = (uint64_t)readBlockWord(ptr, d->end) << 32 | readBlockWord(ptr + 4, d->end);
+    ptr += 8;
+    int buf64Size = 64;
+    int lengths = d->maxSymLen - d->minSymLen + 1;
+    int sym;
+    for (;;)
+    {
+        int len = 0;
+        while (len < lengths - 1 && buf64 < d->base64[len])
+            len++;
+        sym = (int)((buf64 - d->base64[len]) >> (64 - len - d->minSymLen)) + readU16(d->lowestSym + 2 * len);
+        if (sym >= d->symbols)
+            return -1;
+        if (offset < d->symlen[sym] + 1)
+            break;
+        offset -= d->symlen[sym] + 1;
+        len += d->minSymLen;
+        buf64 <<= len;
+        buf64Size -= len;
+        if (buf64Size <= 32)
+        {
+            buf64Size += 32;
+            buf64 |= (uint64_t)readBlockWord(ptr, d->end) << (64 - buf64Size);
+            ptr += 4;
+        }
+    }
+
+    // Down the pair tree to the value
+    while (d->symlen[sym])
+    {
+        int left = leftChild(d, sym);
+        if (offset < d->symlen[left] + 1)
+            sym = left;
+        else
+        {
+            offset -= d->symlen[left] + 1;
+            sym = rightChild(d, sym);
+        }
+    }
+    return leftChild(d, sym);
+}
+
+typedef enum
+{
+    PROBE_FAIL,
+    PROBE_OK,
+    PROBE_CHANGE_STM, // DTZ table of the other side to move
+    PROBE_ZEROING     // Best move is a capture or pawn move
+} ProbeStatus;
+
+static bool pawnOrder(int a, int b)
+{
+    return mapPawns[a] < mapPawns[b];
+}
+
+/* Value of the position's index in 'table' (WDL or, given its WDL, DTZ) */
+static int probeTable(const TBTable *table, const BoardState *board, bool flipped, bool dtz, int wdl,
+                      ProbeStatus *status)
+{
+    // Tables store the stronger side as White, and symmetric material with White to move
+    bool flip = flipped || (table->symmetric && board->currentPlayer == BLACK);
+    int flipColor = flip ? TB_BLACK : 0;
+    int flipSquares = flip ? 56 : 0;
+    int stm = flip ^ (board->currentPlayer == BLACK);
+
+    int squares[TB_MAX_PIECES], pieces[TB_MAX_PIECES];
+    int size = 0, leadPawnsCount = 0, tbFile = 0;
+    Bitboard leadPawns = 0;
+    const PairsData *first = dtz ? &table->dtzPairs[0] : &table->wdlPairs[0][0];
+    if (table->hasPawns)
+    {
+        PieceColor leadColor = ((first->pieces[0] ^ flipColor) & TB_BLACK) ? BLACK : WHITE;
+        leadPawns = board->pieceBB[leadColor][PAWN];
+        for (Bitboard b = leadPawns; b;)
+            squares[size++] = (popLsb(&b) ^ 56) ^ flipSquares;
+        leadPawnsCount = size;
+        if (!leadPawnsCount)
+        {
+            *status = PROBE_FAIL;
+            return 0;
+        }
+
+        // The pawn nearest the edge and the first rank picks the sub-table
+        int best = 0;
+        for (int i = 1; i < leadPawnsCount; i++)
+            if (pawnOrder(squares[best], squares[i]))
+                best = i;
+        int tmp = squares[0];
+        squares[0] = squares[best];
+        squares[best] = tmp;
+        tbFile = TB_FILE(squares[0]) < 4 ? TB_FILE(squares[0]) : 7 - TB_FILE(squares[0]);
+    }
+
+    const PairsData *d = dtz ? &table->dtzPairs[tbFile] : &table->wdlPairs[stm][tbFile];
+    if (dtz && (d->flags & TB_STM) != stm && !(table->symmetric && !table->hasPawns))
+    {
+        *status = PROBE_CHANGE_STM;
+        return 0;
+    }
+
+    for (Bitboard b = board->occupiedBB & ~leadPawns; b;)
+    {
+        int sq = popLsb(&b);
+        Piece piece = board->squares[SQ_ROW(sq)][SQ_COL(sq)];
+        squares[size] = (sq ^ 56) ^ flipSquares;
+        pieces[size++] = (int)piece.type | ((piece.color == BLACK ? TB_BLACK : 0) ^ flipColor);
+    }
+    if (size != table->pieces)
+    {
+        *status = PROBE_FAIL;
+        return 0;
+    }
+
+    // Same order as the table's pieces
+    for (int i = leadPawnsCount; i < size - 1; i++)
+        for (int j = i + 1; j < size; j++)
+            if (d->pieces[i] == pieces[j])
+            {
+                int tmp = pieces[i];
+                pieces[i] = pieces[j];
+                pieces[j] = tmp;
+                tmp = squares[i];
+                squares[i] = squares[j];
+                squares[j] = tmp;
+                break;
+            }
+
+    if (TB_FILE(squares[0]) > 3)
+        for (int i = 0; i < size; i++)
+            squares[i] ^= 7;
+
+    uint64_t idx;
+    if (table->hasPawns)
+    {
+        idx = leadPawnIdx[leadPawnsCount][squares[0]];
+        for (int i = 2; i < leadPawnsCount; i++) // Insertion sort by mapPawns
+            for (int j = i; j > 1 && pawnOrder(squares[j], squares[j - 1]); j--)
+            {
+                int tmp = squares[j];
+                squares[j] = squares[j - 1];
+                squares[j - 1] = tmp;
+            }
+        for (int i = 1; i < leadPawnsCount; i++)
+            idx += binomial[i][mapPawns[squares[i]]];
+    }
+    else
+    {
+        if (TB_RANK(squares[0]) > 3)
+            for (int i = 0; i < size; i++)
+                squares[i] ^= 56;
+
+        // Mirror on the diagonal if the first piece off it lies above
+        for (int i = 0; i < d->groupLen[0]; i++)
+        {
+            if (!TB_OFF_DIAGONAL(squares[i]))
+                continue;
+            if (TB_OFF_DIAGONAL(squares[i]) > 0)
+                for (int j = i; j < size; j++)
+                    squares[j] = ((squares[j] >> 3) | (squares[j] << 3)) & 63;
+            break;
+        }
+
+        if (table->uniquePieces)
+        {
+            int adjust1 = squares[1] > squares[0];
+            int adjust2 = (squares[2] > squares[0]) + (squares[2] > squares[1]);
+            if (TB_OFF_DIAGONAL(squares[0]))
+                idx = (uint64_t)((mapA1D1D4[squares[0]] * 63 + (squares[1] - adjust1)) * 62 + squares[2] - adjust2);
+            else if (TB_OFF_DIAGONAL(squares[1]))
+                idx = (uint64_t)((6 * 63 + TB_RANK(squares[0]) * 28 + mapB1H1H7[squares[1]]) * 62 + squares[2] -
+                                 adjust2);
+            else if (TB_OFF_DIAGONAL(squares[2]))
+                idx = (uint64_t)(6 * 63 * 62 + 4 * 28 * 62 + TB_RANK(squares[0]) * 7 * 28 +
+                                 (TB_RANK(squares[1]) - adjust1) * 28 + mapB1H1H7[squares[2]]);
+            else
+                idx = (uint64_t)(6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 + TB_RANK(squares[0]) * 7 * 6 +
+                                 (TB_RANK(squares[1]) - adjust1) * 6 + (TB_RANK(squares[2]) - adjust2));
+        }
+        else
+            idx = (uint64_t)mapKK[mapA1D1D4[squares[0]]][squares[1]];
+    }
+
+    // The remaining groups: combinations of the squares still free
+    idx *= d->groupIdx[0];
+    int *groupSq = squares + d->groupLen[0];
+    bool remainingPawns = table->hasPawns && table->pawnCount[1];
+    for (int next = 1; d->groupLen[next]; next++)
+    {
+        int len = d->groupLen[next];
+        for (int i = 1; i < len; i++) // Insertion sort, ascending
+            for (int j = i; j > 0 && groupSq[j] < groupSq[j - 1]; j--)
+            {
+                int tmp = groupSq[j];
+                groupSq[j] = groupSq[j - 1];
+                groupSq[j - 1] = tmp;
+            }
+        uint64_t n = 0;
+        for (int i = 0; i < len; i++)
+        {
+            // Squares of the earlier groups below ours are not available
+            int adjust = 0;
+            for (const int *s = squares; s < groupSq; s++)
+                adjust += groupSq[i] > *s;
+            int available = groupSq[i] - adjust - (remainingPawns ? 8 : 0);
+            if (available < 0)
+            {
+                *status = PROBE_FAIL;
+                return 0;
+            }
+            n += binomial[i + 1][available];
+        }
+        remainingPawns = false;
+        idx += n * d->groupIdx[next];
+        groupSq += len;
+    }
+
+    int value = decompressPairs(d, idx);
+    if (value < 0)
+    {
+        *status = PROBE_FAIL;
+        return 0;
+    }
+    if (!dtz)
+    {
+        if (value > 4)
+            *status = PROBE_FAIL;
+        return value - 2;
+    }
+
+    // Map and convert DTZ values to plies
+    static const int wdlMap[5] = {1, 3, 0, 2, 0};
+    if (d->flags & TB_MAPPED)
+    {
+        size_t at = (size_t)(d->mapIdx[wdlMap[wdl + 2]] + value);
+        bool wide = d->flags & TB_WIDE;
+        if ((wide ? 2 * at + 2 : at + 1) > table->dtzMapSize)
+        {
+            *status = PROBE_FAIL;
+            return 0;
+        }
+        value = wide ? readU16(table->dtzMap + 2 * at) : table->dtzMap[at];
+    }
+    if ((wdl == TB_WIN && !(d->flags & TB_WIN_PLIES)) || (wdl == TB_LOSS && !(d->flags & TB_LOSS_PLIES)) ||
+        wdl == TB_CURSED_WIN || wdl == TB_BLESSED_LOSS)
+        value *= 2;
+    return value + 1;
+}
+
+/* Table lookup of the position as it stands (KvK needs none) */
+static int probeTableFor(const BoardState *board, bool dtz, int wdl, ProbeStatus *status)
+{
+    if (popCount(board->occupiedBB) == 2)
+        return TB_DRAW;
+    bool flipped;
+    const TBTable *table = tableFor(board, &flipped);
+    if (!table || !(dtz ? table->dtz : table->wdl))
+    {
+        *status = PROBE_FAIL;
+        return 0;
+    }
+    return probeTable(table, board, flipped, dtz, wdl, status);
+}
+
+static bool isZeroing(const BoardState *board, Move move)
+{
+    return board->squares[SQ_ROW(move.to)][SQ_COL(move.to)].type != EMPTY || move.flag == MOVE_EN_PASSANT ||
+           board->squares[SQ_ROW(move.from)][SQ_COL(move.from)].type == PAWN;
+}
+
+static bool isCapture(const BoardState *board, Move move)
+{
+    return board->squares[SQ_ROW(move.to)][SQ_COL(move.to)].type != EMPTY || move.flag == MOVE_EN_PASSANT;
+}
+
+/*
+ * WDL value of the position. The tables assume the position was reached by
+ * a zeroing move and that no capture is available (positions with one
+ * store whatever compresses best), so captures - and with 'zeroingMoves'
+ * pawn moves too - are tried first. PROBE_ZEROING reports that one of them
+ * is the best move.
+ */
+static int searchWdl(BoardState *board, bool zeroingMoves, ProbeStatus *status)
+{
+    Move moves[MAX_MOVES_IN_LIST];
+    int total = generateLegalMoves(board, moves);
+    int bestValue = TB_LOSS, moveCount = 0, value;
+
+    for (int i = 0; i < total; i++)
+    {
+        if (zeroingMoves ? !isZeroing(board, moves[i]) : !isCapture(board, moves[i]))
+            continue;
+        moveCount++;
+        MoveRecord record;
+        makeMove(board, moves[i], &record);
+        value = -searchWdl(board, false, status);
+        undoMove(board, &record);
+        if (*status == PROBE_FAIL)
+            return TB_DRAW;
+        if (value > bestValue)
+        {
+            bestValue = value;
+            if (value >= TB_WIN)
+            {
+                *status = PROBE_ZEROING;
+                return value;
+            }
+        }
+    }
+
+    // With every move tried the table is not needed
+    bool noMoreMoves = moveCount && moveCount == total;
+    if (noMoreMoves)
+        value = bestValue;
+    else
+    {
+        value = probeTableFor(board, false, TB_DRAW, status);
+        if (*status == PROBE_FAIL)
+            return TB_DRAW;
+    }
+
+    if (bestValue >= value)
+    {
+        *status = (bestValue > TB_DRAW || noMoreMoves) ? PROBE_ZEROING : PROBE_OK;
+        return bestValue;
+    }
+    *status = PROBE_OK;
+    return value;
+}
+
+/* DTZ of a position whose best move is zeroing, from its WDL value */
+static int dtzBeforeZeroing(int wdl)
+{
+    return wdl == TB_WIN ? 1 : wdl == TB_CURSED_WIN ? 101 : wdl == TB_BLESSED_LOSS ? -101 : wdl == TB_LOSS ? -1 : 0;
+}
+
+static int sign(int value)
+{
+    return (value > 0) - (value < 0);
+}
+
+static int searchDtz(BoardState *board, ProbeStatus *status)
+{
+    *status = PROBE_OK;
+    int wdl = searchWdl(board, true, status);
+    if (*status == PROBE_FAIL || wdl == TB_DRAW)
+        return 0;
+    if (*status == PROBE_ZEROING)
+        return dtzBeforeZeroing(wdl);
+
+    int dtz = probeTableFor(board, true, wdl, status);
+    if (*status == PROBE_FAIL)
+        return 0;
+    if (*status != PROBE_CHANGE_STM)
+        return (dtz + 100 * (wdl == TB_BLESSED_LOSS || wdl == TB_CURSED_WIN)) * sign(wdl);
+
+    // Only the other side to move is stored: one ply of search
+    Move moves[MAX_MOVES_IN_LIST];
+    int total = generateLegalMoves(board, moves);
+    int minDtz = 0xFFFF;
+    for (int i = 0; i < total; i++)
+    {
+        bool zeroing = isZeroing(board, moves[i]);
+        MoveRecord record;
+        makeMove(board, moves[i], &record);
+        dtz = zeroing ? -dtzBeforeZeroing(searchWdl(board, false, status)) : -searchDtz(board, status);
+
+        // A mate is a zeroing move of its own
+        if (dtz == 1 && isKingInCheck(board, board->currentPlayer))
+        {
+            Move replies[MAX_MOVES_IN_LIST];
+            if (!generateLegalMoves(board, replies))
+                minDtz = 1;
+        }
+        undoMove(board, &record);
+        if (*status == PROBE_FAIL)
+            return 0;
+
+        if (!zeroing)
+            dtz += sign(dtz);
+        if (dtz < minDtz && sign(dtz) == sign(wdl))
+            minDtz = dtz;
+    }
+    return minDtz == 0xFFFF ? -1 : minDtz;
+}
+
+/* ---------- Loading ---------- */
+
+#ifdef TB_HAVE_MMAP
+
+/* Maps 'path' read-only and checks its magic number */
+static const uint8_t *mapTableFile(const char *path, const uint8_t *magic, size_t *size)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size >= 4)
+        data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // The mapping stays valid without the descriptor
+    if (data == MAP_FAILED)
+        return NULL;
+
+    if (memcmp(data, magic, 4) != 0)
+    {
+        munmap(data, (size_t)st.st_size);
+        return NULL;
+    }
+    *size = (size_t)st.st_size;
+    return data;
+}
+
+/* Registers one directory entry if it is a WDL or DTZ file */
+static void addFile(const char *dir, const char *file)
+{
+    const char *dot = strrchr(file, '.');
+    if (!dot || (size_t)(dot - file) >= TB_NAME_LENGTH)
+        return;
+    bool isWdl = !strcmp(dot, ".rtbw");
+    if (!isWdl && strcmp(dot, ".rtbz"))
+        return;
+
+    char stem[TB_NAME_LENGTH];
+    memcpy(stem, file, (size_t)(dot - file));
+    stem[dot - file] = '\0';
+    int pieces = parseTableName(stem);
+    if (!pieces)
+        return;
+
+    char path[4096];
+    if ((size_t)snprintf(path, sizeof(path), "%s/%s", dir, file) >= sizeof(path))
+        return;
+    size_t size = 0;
+    const uint8_t *data = mapTableFile(path, isWdl ? WDL_MAGIC : DTZ_MAGIC, &size);
+    if (!data)
+        return;
+
+    // Tables are unsorted while loading: pair the two files of one signature by a scan
+    TBTable *table = NULL;
+    for (int i = 0; i < tableCount && !table; i++)
+        if (!strcmp(tables[i].name, stem))
+            table = &tables[i];
+    if (!table)
+    {
+        TBTable *grown = realloc(tables, sizeof(TBTable) * (size_t)(tableCount + 1));
+        if (!grown)
+        {
+            munmap((void *)data, size);
+            return;
+        }
+        tables = grown;
+        table = &tables[tableCount++];
+        memset(table, 0, sizeof(*table));
+        strcpy(table->name, stem);
+        table->pieces = pieces;
+    }
+
+    // The same table in two directories: the first one found wins
+    const uint8_t **slot = isWdl ? &table->wdl : &table->dtz;
+    size_t *slotSize = isWdl ? &table->wdlSize : &table->dtzSize;
+    if (*slot)
+    {
+        munmap((void *)data, size);
+        return;
+    }
+    *slot = data;
+    *slotSize = size;
+}
+
+static void scanDirectory(const char *dir)
+{
+    DIR *d = opendir(dir);
+    if (!d)
+        return;
+    for (struct dirent *entry = readdir(d); entry; entry = readdir(d))
+        addFile(dir, entry->d_name);
+    closedir(d);
+}
+
+#endif // TB_HAVE_MMAP
+
+/* ---------- Public API ---------- */
+
+int tbInit(const char *paths)
+{
+    tbFree();
+    if (!paths || !*paths)
+        return 0;
+    initIndexTables();
+
+#ifdef TB_HAVE_MMAP
+    char *list = malloc(strlen(paths) + 1);
+    if (!list)
+        return 0;
+    strcpy(list, paths);
+    for (char *dir = list; dir;)
+    {
+        char *next = strchr(dir, ':');
+        if (next)
+            *next++ = '\0';
+        if (*dir)
+            scanDirectory(dir);
+        dir = next;
+    }
+    free(list);
+
+    // Headers are read once here, so probes from several threads only read
+    for (int i = 0; i < tableCount; i++)
+    {
+        TBTable *table = &tables[i];
+        setMaterial(table);
+        if (table->wdl && !parseTable(table, false))
+        {
+            fprintf(stderr, "Syzygy: %s.rtbw is damaged or does not match its name, ignored\n", table->name);
+            freeTable(table, false);
+            munmap((void *)table->wdl, table->wdlSize);
+            table->wdl = NULL;
+        }
+        if (table->dtz && !parseTable(table, true))
+        {
+            fprintf(stderr, "Syzygy: %s.rtbz is damaged or does not match its name, ignored\n", table->name);
+            freeTable(table, true);
+            munmap((void *)table->dtz, table->dtzSize);
+            table->dtz = NULL;
+        }
+        if (table->wdl && table->pieces > largest)
+            largest = table->pieces;
+    }
+#endif
+
+    if (tableCount > 1)
+        qsort(tables, (size_t)tableCount, sizeof(TBTable), compareTables);
+
+    int files = 0;
+    for (int i = 0; i < tableCount; i++)
+        files += (tables[i].wdl != NULL) + (tables[i].dtz != NULL);
+    return files;
+}
+
+void tbFree(void)
+{
+    for (int i = 0; i < tableCount; i++)
+    {
+        freeTable(&tables[i], false);
+        freeTable(&tables[i], true);
+#ifdef TB_HAVE_MMAP
+        if (tables[i].wdl)
+            munmap((void *)tables[i].wdl, tables[i].wdlSize);
+        if (tables[i].dtz)
+            munmap((void *)tables[i].dtz, tables[i].dtzSize);
+#endif
+    }
+    free(tables);
+    tables = NULL;
+    tableCount = 0;
+    largest = 0;
+}
+
+int tbLargest(void)
+{
+    return largest;
+}
+
+bool tbProbeWdl(const BoardState *board, TBResult *result)
+{
+    BoardState copy = *board;
+    ProbeStatus status = PROBE_OK;
+    int value = searchWdl(&copy, false, &status);
+    if (status == PROBE_FAIL)
+        return false;
+    *result = (TBResult)value;
+    return true;
+}
+
+bool tbProbeDtz(const BoardState *board, int *dtz)
+{
+    BoardState copy = *board;
+    ProbeStatus status = PROBE_OK;
+    int value = searchDtz(&copy, &status);
+    if (status == PROBE_FAIL)
+        return false;
+    *dtz = value;
+    return true;
+}
+
+/* ---------- Self Check ---------- */
+
+/*
+ * Positions with results that follow from the rules alone: plain wins,
+ * mates in one, a stalemate, captures into KvK, the colour-flipped lookup
+ * of a table, and the textbook king-and-pawn cases (king on the sixth in
+ * front of its pawn wins; the defender holding the opposition draws).
+ */
+static const struct
+{
+    const char *table;
+    const char *fen;
+    TBResult wdl;
+    int dtz; // 0: not checked (any value of the right sign)
+} tbReference[] = {
+    {"KQvK", "4k3/8/8/8/8/8/8/3QK3 w - - 0 1", TB_WIN, 0},
+    {"KQvK", "4k3/8/8/8/8/8/8/3QK3 b - - 0 1", TB_LOSS, 0},
+    {"KQvK", "k7/8/1K6/8/8/8/7Q/8 w - - 0 1", TB_WIN, 1},
+    {"KQvK", "k7/2Q5/1K6/8/8/8/8/8 b - - 0 1", TB_DRAW, 0},
+    {"KQvK", "8/8/8/8/8/8/1q6/K1k5 w - - 0 1", TB_LOSS, 0},
+    {"KRvK", "8/8/8/8/4k3/8/8/R3K3 w - - 0 1", TB_WIN, 0},
+    {"KRvK", "6k1/8/6K1/8/8/8/8/R7 w - - 0 1", TB_WIN, 1},
+    {"KRvK", "K7/8/8/8/8/8/6k1/6R1 b - - 0 1", TB_DRAW, 0},
+    {"KRvK", "8/8/8/8/8/8/1r6/K1k5 b - - 0 1", TB_WIN, 0},
+    {"KPvK", "4k3/8/4K3/4P3/8/8/8/8 w - - 0 1", TB_WIN, 0},
+    {"KPvK", "8/8/8/8/4p3/4k3/8/4K3 b - - 0 1", TB_WIN, 0},
+    {"KPvK", "4k3/8/4P3/4K3/8/8/8/8 w - - 0 1", TB_DRAW, 0},
+    {"KPvK", "8/8/8/8/4k3/4p3/8/4K3 b - - 0 1", TB_DRAW, 0},
+    {"KPvK", "8/8/8/8/8/8/kP6/7K b - - 0 1", TB_DRAW, 0},
+};
+
+bool tbSelfCheckAvailable(void)
+{
+    for (size_t i = 0; i < sizeof(tbReference) / sizeof(tbReference[0]); i++)
+    {
+        const TBTable *table = findTable(tbReference[i].table);
+        if (table && table->wdl)
+            return true;
+    }
+    return false;
+}
+
+bool tbSelfCheck(void)
+{
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(tbReference) / sizeof(tbReference[0]); i++)
+    {
+        const TBTable *table = findTable(tbReference[i].table);
+        if (!table || !table->wdl)
+            continue;
+
+        BoardState board;
+        loadBoardFromFEN(tbReference[i].fen, &board);
+        TBResult wdl;
+        if (!tbProbeWdl(&board, &wdl) || wdl != tbReference[i].wdl)
+        {
+            printf("  %s: WDL probe failed or differs (expected %d)\n", tbReference[i].fen, tbReference[i].wdl);
+            ok = false;
+            continue;
+        }
+
+        int dtz;
+        if (table->dtz && (!tbProbeDtz(&board, &dtz) || sign(dtz) != sign(tbReference[i].wdl) ||
+                           (tbReference[i].dtz && dtz != tbReference[i].dtz)))
+        {
+            printf("  %s: DTZ probe failed or differs\n", tbReference[i].fen);
+            ok = false;
+        }
+    }
+    return ok;
+}
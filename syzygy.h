@@ -0,0 +1,81 @@
+#ifndef SYZYGY_H
+#define SYZYGY_H
+
+#include <stdbool.h>
+#include "structs.h"
+
+/*
+ * Syzygy endgame tablebases.
+ *
+ * tbInit() scans the given directories for .rtbw (win/draw/loss) and .rtbz
+ * (distance to zeroing move) files and memory-maps every one it recognises.
+ * Mapping costs nothing at startup, pages are read only when a probe touches
+ * them, and the OS page cache is shared by every engine process using the
+ * same files.
+ *
+ * Headers are read once in tbInit(), which drops files that do not match
+ * their material. A probe then indexes the position the way the generator
+ * did (board symmetries, groups of equal pieces) and decodes that one value
+ * from its compressed block; captures, and for DTZ pawn moves, are resolved
+ * by a small search first because the tables do not store positions where
+ * one of them is the best move. Probes only read shared data, so search
+ * threads can probe concurrently.
+ */
+
+#define TB_MAX_PIECES 7
+
+/* Game-theoretical value from the side to move's point of view */
+typedef enum
+{
+    TB_LOSS = -2,
+    TB_BLESSED_LOSS = -1, // Lost, but the 50-move rule saves it
+    TB_DRAW = 0,
+    TB_CURSED_WIN = 1, // Won, but not within the 50-move rule
+    TB_WIN = 2
+} TBResult;
+
+/**
+ * @brief Maps the tablebase files found in 'paths' (directories separated by ':').
+ * Replaces any previously loaded set; an empty path just unloads.
+ * @return Number of files mapped.
+ */
+int tbInit(const char *paths);
+
+/**
+ * @brief Unmaps every file.
+ */
+void tbFree(void);
+
+/**
+ * @brief Most pieces (kings included) of any loaded WDL table; 0 if none.
+ */
+int tbLargest(void);
+
+/**
+ * @brief Win/draw/loss of the position, assuming it was just reached by a zeroing move.
+ * Must only be called without castling rights and with at most tbLargest() pieces.
+ * @return false if the table is missing or could not be read.
+ */
+bool tbProbeWdl(const BoardState *board, TBResult *result);
+
+/**
+ * @brief Distance in plies to the next capture or pawn move on the best path,
+ * signed like the WDL result (positive when winning).
+ * @return false if the table is missing or could not be read.
+ */
+bool tbProbeDtz(const BoardState *board, int *dtz);
+
+/**
+ * @brief True if a table used by tbSelfCheck() is loaded.
+ */
+bool tbSelfCheckAvailable(void);
+
+/**
+ * @brief Probes KQvK, KRvK and KPvK positions whose results follow from the
+ * rules (wins, mates in one, stalemate, captures into KvK, colour-flipped
+ * lookups). Positions of tables that are not loaded are skipped.
+ * @return false (after printing the mismatches) if any result differs.
+ */
+bool tbSelfCheck(void);
+
+#endif // SYZYGY_H
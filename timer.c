@@ -0,0 +1,17 @@
+// clock_gettime() is POSIX, not ISO C
+#define _POSIX_C_SOURCE 200809L
+
+#include "timer.h"
+#include <time.h>
+
+int64_t nowMs(void)
+{
+    struct timespec ts;
+#ifdef CLOCK_MONOTONIC
+    // Unaffected by NTP steps or the clock being set while a search runs
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+        return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+#endif
+    timespec_get(&ts, TIME_UTC);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
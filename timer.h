@@ -0,0 +1,12 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdint.h>
+
+/**
+ * @brief Milliseconds on a monotonic clock (the wall clock where there is
+ * none); only differences between two calls are meaningful.
+ */
+int64_t nowMs(void);
+
+#endif // TIMER_H
@@ -0,0 +1,333 @@
+#include "tt.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Entry layout: (key XOR data) plus one packed 64-bit data word
+ *   bits  0-15  best move (see packMove; 0 = none)
+ *   bits 16-23  depth
+ *   bits 24-25  bound (TTBound)
+ *   bits 26-31  generation of the search that wrote it
+ *   bits 32-63  score (signed)
+ *
+ * The table is shared by all search threads without locks. The two words are
+ * written independently, so a reader can see one half of an entry from one
+ * store and the other half from another. Storing key ^ data makes such a torn
+ * entry fail the key check (lockless hashing), so it reads as a miss instead
+ * of returning another position's data.
+ */
+
+typedef struct
+{
+    _Atomic uint64_t check; // key ^ data
+    _Atomic uint64_t data;
+} TTEntry;
+
+typedef struct
+{
+    TTEntry entries[TT_BUCKET_SIZE];
+} TTBucket; // 64 bytes: exactly one cache line
+
+_Static_assert(sizeof(TTBucket) == 64, "a TT bucket must fill exactly one cache line");
+
+#define MB (1024 * 1024)
+#define GENERATION_MASK 63
+
+struct TTTable
+{
+    TTBucket *buckets;
+    size_t bucketCount;
+    unsigned generation;
+};
+
+static TTTable shared = {NULL, 0, 0};
+
+// Table of the calling thread when it selected a private one (see ttSelect)
+static _Thread_local TTTable *selected = NULL;
+
+static TTTable *activeTable(void)
+{
+    return selected ? selected : &shared;
+}
+
+/* ---------- Move packing ---------- */
+
+/*
+ * 16-bit move: from square (6 bits), to square (6 bits) and a 4-bit tag
+ * 0 = normal, 1 = en passant, 2 = castle king side, 3 = castle queen side,
+ * 4 + (piece - KNIGHT) = promotion to KNIGHT/BISHOP/ROOK/QUEEN.
+ * a8a8 can never be a real move, so 0 doubles as "no move".
+ */
+static uint16_t packMove(Move m)
+{
+    if (IS_NO_MOVE(m))
+        return 0;
+
+    unsigned tag = 0;
+    switch (m.flag)
+    {
+    case MOVE_EN_PASSANT:
+        tag = 1;
+        break;
+    case MOVE_CASTLE_KING:
+        tag = 2;
+        break;
+    case MOVE_CASTLE_QUEEN:
+        tag = 3;
+        break;
+    case MOVE_PROMOTION:
+        tag = 4 + (unsigned)(m.promotion - KNIGHT);
+        break;
+    default:
+        break;
+    }
+    return (uint16_t)((unsigned)m.from | ((unsigned)m.to << 6) | (tag << 12));
+}
+
+static Move unpackMove(uint16_t packed)
+{
+    Move m = NO_MOVE;
+    if (packed == 0)
+        return m;
+
+    int tag = packed >> 12;
+    m.from = (uint8_t)(packed & 63);
+    m.to = (uint8_t)((packed >> 6) & 63);
+    switch (tag)
+    {
+    case 1:
+        m.flag = MOVE_EN_PASSANT;
+        break;
+    case 2:
+        m.flag = MOVE_CASTLE_KING;
+        break;
+    case 3:
+        m.flag = MOVE_CASTLE_QUEEN;
+        break;
+    case 4:
+    case 5:
+    case 6:
+    case 7:
+        m.flag = MOVE_PROMOTION;
+        m.promotion = (PieceType)(KNIGHT + (tag - 4));
+        break;
+    default:
+        break;
+    }
+    return m;
+}
+
+/* ---------- Data word accessors ---------- */
+
+static uint64_t packData(uint16_t move, int score, int depth, TTBound bound, unsigned generation)
+{
+    if (depth < 0)
+        depth = 0;
+    if (depth > 255)
+        depth = 255;
+    return (uint64_t)move | ((uint64_t)depth << 16) | ((uint64_t)bound << 24) |
+           ((uint64_t)(generation & GENERATION_MASK) << 26) | ((uint64_t)(uint32_t)score << 32);
+}
+
+static uint16_t dataMove(uint64_t data) { return (uint16_t)(data & 0xFFFF); }
+static int dataDepth(uint64_t data) { return (int)((data >> 16) & 0xFF); }
+static TTBound dataBound(uint64_t data) { return (TTBound)((data >> 24) & 3); }
+static unsigned dataGeneration(uint64_t data) { return (unsigned)((data >> 26) & GENERATION_MASK); }
+static int dataScore(uint64_t data) { return (int)(int32_t)(uint32_t)(data >> 32); }
+
+/* How many searches ago an entry was written */
+static int entryAge(const TTTable *t, uint64_t data)
+{
+    return (int)((t->generation - dataGeneration(data)) & GENERATION_MASK);
+}
+
+static TTBucket *bucketFor(const TTTable *t, uint64_t key)
+{
+    return &t->buckets[key & (t->bucketCount - 1)];
+}
+
+/* Relaxed loads/stores: only the key check has to hold, not ordering between entries */
+static uint64_t loadData(const TTEntry *e)
+{
+    return atomic_load_explicit(&e->data, memory_order_relaxed);
+}
+
+static uint64_t loadKey(const TTEntry *e, uint64_t data)
+{
+    return atomic_load_explicit(&e->check, memory_order_relaxed) ^ data;
+}
+
+static void writeEntry(TTEntry *e, uint64_t key, uint64_t data)
+{
+    atomic_store_explicit(&e->check, key ^ data, memory_order_relaxed);
+    atomic_store_explicit(&e->data, data, memory_order_relaxed);
+}
+
+static void clearTable(TTTable *t)
+{
+    if (t->buckets)
+        memset(t->buckets, 0, t->bucketCount * sizeof(TTBucket));
+    t->generation = 0;
+}
+
+static bool allocateTable(TTTable *t, size_t megabytes)
+{
+    if (megabytes < 1)
+        megabytes = 1;
+
+    // Largest power of two number of buckets that fits the budget
+    size_t buckets = 1;
+    while (buckets * 2 * sizeof(TTBucket) <= megabytes * MB)
+        buckets *= 2;
+
+    TTBucket *fresh = aligned_alloc(sizeof(TTBucket), buckets * sizeof(TTBucket));
+    if (!fresh)
+        return false;
+
+    free(t->buckets);
+    t->buckets = fresh;
+    t->bucketCount = buckets;
+    clearTable(t);
+    return true;
+}
+
+/* ---------- Public API ---------- */
+
+bool ttInit(size_t megabytes)
+{
+    return allocateTable(&shared, megabytes);
+}
+
+void ttFree(void)
+{
+    free(shared.buckets);
+    shared.buckets = NULL;
+    shared.bucketCount = 0;
+}
+
+TTTable *ttCreate(size_t megabytes)
+{
+    TTTable *t = calloc(1, sizeof(TTTable));
+    if (t && !allocateTable(t, megabytes))
+    {
+        free(t);
+        return NULL;
+    }
+    return t;
+}
+
+void ttDestroy(TTTable *t)
+{
+    if (selected == t)
+        selected = NULL;
+    if (t)
+        free(t->buckets);
+    free(t);
+}
+
+void ttSelect(TTTable *t)
+{
+    selected = t;
+}
+
+void ttClear(void)
+{
+    clearTable(activeTable());
+}
+
+void ttNewSearch(void)
+{
+    TTTable *t = activeTable();
+    t->generation = (t->generation + 1) & GENERATION_MASK;
+}
+
+void ttProbe(uint64_t key, TTProbe *result)
+{
+    result->found = false;
+    const TTTable *t = activeTable();
+    if (!t->buckets)
+        return;
+
+    TTBucket *bucket = bucketFor(t, key);
+    for (int i = 0; i < TT_BUCKET_SIZE; i++)
+    {
+        const TTEntry *e = &bucket->entries[i];
+        uint64_t data = loadData(e);
+        if (loadKey(e, data) == key && dataBound(data) != TT_NONE)
+        {
+            result->found = true;
+            result->move = unpackMove(dataMove(data));
+            result->score = dataScore(data);
+            result->depth = dataDepth(data);
+            result->bound = dataBound(data);
+            return;
+        }
+    }
+}
+
+void ttStore(uint64_t key, Move move, int score, int depth, TTBound bound)
+{
+    const TTTable *t = activeTable();
+    if (!t->buckets)
+        return;
+
+    TTBucket *bucket = bucketFor(t, key);
+    TTEntry *replace = NULL;
+    uint64_t old = 0;
+
+    // 1. Same position already stored (or a free slot): reuse it
+    for (int i = 0; i < TT_BUCKET_SIZE; i++)
+    {
+        TTEntry *e = &bucket->entries[i];
+        uint64_t data = loadData(e);
+        if (loadKey(e, data) == key || dataBound(data) == TT_NONE)
+        {
+            replace = e;
+            old = data;
+            break;
+        }
+    }
+
+    if (replace && dataBound(old) != TT_NONE)
+    {
+
+        // Depth-preferred: a shallow non-exact result from this search does not
+        // overwrite a clearly deeper one.
+        if (bound != TT_EXACT && entryAge(t, old) == 0 && depth + 2 < dataDepth(old))
+            return;
+
+        // Keep the known best move if this search did not find one
+        uint16_t packed = packMove(move);
+        if (packed == 0)
+            packed = dataMove(old);
+        writeEntry(replace, key, packData(packed, score, depth, bound, t->generation));
+        return;
+    }
+
+    // 2. Bucket full: evict the shallowest entry, counting each search of age as 8 plies
+    if (!replace)
+    {
+        replace = &bucket->entries[0];
+        uint64_t data = loadData(replace);
+        int worst = dataDepth(data) - 8 * entryAge(t, data);
+        for (int i = 1; i < TT_BUCKET_SIZE; i++)
+        {
+            TTEntry *e = &bucket->entries[i];
+            data = loadData(e);
+            int value = dataDepth(data) - 8 * entryAge(t, data);
+            if (value < worst)
+            {
+                worst = value;
+                replace = e;
+            }
+        }
+    }
+
+    writeEntry(replace, key, packData(packMove(move), score, depth, bound, t->generation));
+}
+
+size_t ttSizeMB(void)
+{
+    return shared.bucketCount * sizeof(TTBucket) / MB;
+}
@@ -0,0 +1,94 @@
+#ifndef TT_H
+#define TT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "structs.h"
+
+/*
+ * Transposition table.
+ *
+ * Results of earlier searches keyed by Zobrist hash. The table is an array of
+ * 64-byte buckets (one cache line each) holding TT_BUCKET_SIZE entries; a key
+ * maps to one bucket and may live in any of its slots. When a bucket is full
+ * the entry with the lowest (depth - age penalty) is replaced, so deep results
+ * from the current search survive while stale ones from earlier searches are
+ * recycled.
+ *
+ * All search threads share the one table; probes and stores need no locking
+ * (see tt.c for how torn entries are detected). A thread may instead select a
+ * private table of its own (ttCreate/ttSelect), e.g. to keep independent
+ * searches from influencing each other.
+ *
+ * Scores are stored exactly as given: the search is responsible for converting
+ * mate scores between "distance from root" and "distance from this node".
+ */
+
+#define TT_BUCKET_SIZE 4
+#define TT_DEFAULT_MB 64
+
+typedef enum
+{
+    TT_NONE,  // Empty slot
+    TT_EXACT, // Score is exact (PV node)
+    TT_LOWER, // Score is a lower bound (failed high)
+    TT_UPPER  // Score is an upper bound (failed low)
+} TTBound;
+
+typedef struct
+{
+    bool found;
+    Move move; // Best/refutation move; NO_MOVE if none stored
+    int score;
+    int depth;
+    TTBound bound;
+} TTProbe;
+
+/**
+ * @brief (Re)allocates the shared table with roughly 'megabytes' MB (rounded down to a power of two buckets).
+ * @return false if the allocation failed; the previous table is kept in that case.
+ */
+bool ttInit(size_t megabytes);
+
+/* Releases the table memory */
+void ttFree(void);
+
+typedef struct TTTable TTTable;
+
+/**
+ * @brief Allocates a private table of roughly 'megabytes' MB, separate from the shared one.
+ * @return NULL if the allocation failed.
+ */
+TTTable *ttCreate(size_t megabytes);
+
+/* Releases a private table (deselecting it if the calling thread uses it) */
+void ttDestroy(TTTable *table);
+
+/**
+ * @brief Makes every following call from this thread (clear, new search, probe, store)
+ * use 'table'; NULL returns it to the shared table. Helper threads started by a
+ * search always use the shared one.
+ */
+void ttSelect(TTTable *table);
+
+/* Empties every bucket (new game) */
+void ttClear(void);
+
+/* Starts a new search generation so entries from older searches age out */
+void ttNewSearch(void);
+
+/**
+ * @brief Looks up a position. result->found is false on a miss.
+ */
+void ttProbe(uint64_t key, TTProbe *result);
+
+/**
+ * @brief Stores a search result, applying the replacement policy.
+ */
+void ttStore(uint64_t key, Move move, int score, int depth, TTBound bound);
+
+/* Current size of the shared table in MB (0 if not allocated) */
+size_t ttSizeMB(void);
+
+#endif // TT_H
@@ -0,0 +1,482 @@
+/*
+ * ======================================================================================
+ * File: uci.c
+ * Description: Universal Chess Interface front end.
+ *
+ * The input loop runs on the calling thread and never blocks on a search:
+ * "go" copies the current position into a worker thread, which runs
+ * findBestMove() and prints "bestmove" itself. "stop" and "ponderhit" only
+ * flip flags the running search polls.
+ *
+ * Pondering ("go ponder") and "go infinite" search without a clock; UCI
+ * forbids sending "bestmove" before the GUI ends them, so a worker that
+ * finishes early waits for "stop" or "ponderhit" before reporting.
+ * ======================================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "uci.h"
+#include "fileio.h"
+#include "game.h"
+#include "movegen.h"
+#include "tt.h"
+#include "pawns.h"
+#include "syzygy.h"
+#include "book.h"
+#include "nnue.h"
+
+#define UCI_ENGINE_NAME "C-ChessEngine"
+#define UCI_ENGINE_AUTHOR "Amogh Gurudatta"
+
+#define UCI_LINE_LENGTH 65536 // "position startpos moves ..." grows with the game
+#define UCI_MAX_TOKENS 2048
+
+#define UCI_MAX_HASH_MB 65536
+#define UCI_MOVE_OVERHEAD 30     // Milliseconds kept back for GUI / pipe latency
+#define UCI_DEFAULT_MOVES_TO_GO 30 // Assumed moves left when the GUI does not say
+
+typedef struct
+{
+    BoardState board; // Set by "position"
+    SearchParams params;
+    int threads;
+    int multiPV;    // MultiPV option: lines searched and reported per iteration
+    bool showStats; // SearchStats option: an "info string" line of counters per iteration
+    uint64_t bookRandom; // Random state of the book picks (0 = not seeded yet)
+
+    // Current search; the worker owns everything below while 'searching'
+    pthread_t worker;
+    bool searching;   // Worker started and not yet joined
+    BoardState searchBoard;
+    SearchLimits limits;
+    atomic_bool stop;
+    atomic_bool ponder;
+    bool infinite; // "go infinite": wait for "stop" before answering
+
+    pthread_mutex_t lock;     // Guards the wait below
+    pthread_cond_t released;  // Signalled on "stop" and "ponderhit"
+} UciState;
+
+/* ---------- Output ---------- */
+
+/* One line per call, flushed at once: the GUI reads a pipe */
+static void uciSend(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    fflush(stdout);
+}
+
+int uciScoreValue(int score, bool *mate)
+{
+    *mate = IS_MATE_SCORE(score);
+    if (!*mate)
+    {
+        // Tablebase wins: a bounded cp value that still prefers the nearer win
+        if (IS_DECISIVE_SCORE(score))
+            return score > 0 ? UCI_TB_WIN_CP - (TB_WIN_SCORE - score) : -UCI_TB_WIN_CP + (TB_WIN_SCORE + score);
+        return score;
+    }
+    // Plies to mate -> moves to mate, negative when we are the one mated
+    int plies = MATE_VALUE - (score > 0 ? score : -score);
+    return score > 0 ? (plies + 1) / 2 : -(plies / 2);
+}
+
+static void formatScore(int score, char *out, size_t size)
+{
+    bool mate;
+    int value = uciScoreValue(score, &mate);
+    snprintf(out, size, "%s %d", mate ? "mate" : "cp", value);
+}
+
+/* Answer to "uci": who we are and which options we take */
+static void sendIdentity(const UciState *s)
+{
+    uciSend("id name %s\n", UCI_ENGINE_NAME);
+    uciSend("id author %s\n", UCI_ENGINE_AUTHOR);
+    uciSend("option name Hash type spin default %zu min 1 max %d\n", ttSizeMB(), UCI_MAX_HASH_MB);
+    uciSend("option name Threads type spin default %d min 1 max %d\n", s->threads, MAX_SEARCH_THREADS);
+    uciSend("option name Ponder type check default false\n");
+    uciSend("option name MultiPV type spin default 1 min 1 max %d\n", MAX_MULTI_PV);
+    uciSend("option name SearchStats type check default false\n");
+    uciSend("option name BookFile type string default <empty>\n");
+    uciSend("option name EvalFile type string default <empty>\n");
+    uciSend("option name SyzygyPath type string default <empty>\n");
+    uciSend("option name SyzygyProbeLimit type spin default %d min 0 max %d\n", s->params.tbProbeLimit,
+            TB_MAX_PIECES);
+    uciSend("uciok\n");
+}
+
+/* Progress callback: one "info" line per completed iteration, or per line with MultiPV */
+static void reportIteration(const SearchResult *result, void *data)
+{
+    const UciState *s = data;
+    for (int l = 0; l < result->lineCount; l++)
+    {
+        const SearchLine *pv = &result->lines[l];
+        char line[112 + MAX_PV_LENGTH * 6];
+        char score[24];
+        formatScore(pv->score, score, sizeof(score));
+
+        char multiPV[24] = "";
+        if (s->multiPV > 1)
+            snprintf(multiPV, sizeof(multiPV), " multipv %d", l + 1);
+
+        int length = snprintf(
+            line, sizeof(line), "info depth %d seldepth %d%s score %s nodes %llu nps %llu tbhits %llu time %lld pv",
+            result->depth, result->stats.selDepth, multiPV, score, (unsigned long long)result->nodes,
+            (unsigned long long)(result->timeMs > 0 ? result->nodes * 1000 / (uint64_t)result->timeMs : result->nodes),
+            (unsigned long long)result->tbHits, (long long)result->timeMs);
+        for (int i = 0; i < pv->pvLength && length < (int)sizeof(line) - 7; i++)
+        {
+            char move[6];
+            moveToString(pv->pv[i], move);
+            length += snprintf(line + length, sizeof(line) - (size_t)length, " %s", move);
+        }
+        uciSend("%s\n", line);
+    }
+
+    if (s->showStats)
+    {
+        const SearchStats *st = &result->stats;
+        uciSend("info string stats qsnodes %llu ttprobes %llu tthits %llu ttcutoffs %llu firstcutoff %.1f%% ebf %.2f\n",
+                (unsigned long long)st->qsNodes, (unsigned long long)st->ttProbes, (unsigned long long)st->ttHits,
+                (unsigned long long)st->ttCutoffs, 100.0 * firstMoveCutoffRate(st), effectiveBranchingFactor(st));
+    }
+}
+
+/* ---------- Search Worker ---------- */
+
+static void *searchWorker(void *arg)
+{
+    UciState *s = arg;
+    SearchResult result;
+    Move best = findBestMove(&s->searchBoard, &s->limits, &result);
+
+    // Pondering and infinite searches may only answer once the GUI ends them
+    pthread_mutex_lock(&s->lock);
+    while (!atomic_load(&s->stop) && (s->infinite || atomic_load(&s->ponder)))
+        pthread_cond_wait(&s->released, &s->lock);
+    pthread_mutex_unlock(&s->lock);
+
+    char move[6] = "0000"; // UCI null move: no legal move in the position
+    char reply[6];
+    if (!IS_NO_MOVE(best))
+        moveToString(best, move);
+    if (result.pvLength > 1)
+    {
+        moveToString(result.pv[1], reply);
+        uciSend("bestmove %s ponder %s\n", move, reply);
+    }
+    else
+        uciSend("bestmove %s\n", move);
+    return NULL;
+}
+
+/* Ends the running search (if any) and waits until it has answered */
+static void stopSearch(UciState *s)
+{
+    if (!s->searching)
+        return;
+
+    pthread_mutex_lock(&s->lock);
+    atomic_store(&s->stop, true);
+    pthread_cond_broadcast(&s->released);
+    pthread_mutex_unlock(&s->lock);
+
+    pthread_join(s->worker, NULL);
+    s->searching = false;
+}
+
+/* ---------- Commands ---------- */
+
+/* Plays a move given in long algebraic notation, if it is legal */
+static bool playMove(BoardState *board, const char *text)
+{
+    MoveList list;
+    generateAllLegalMoves(board, &list);
+    for (int i = 0; i < list.count; i++)
+    {
+        char candidate[6];
+        moveToString(list.moves[i], candidate);
+        if (!strcmp(candidate, text))
+        {
+            MoveRecord played;
+            makeMove(board, list.moves[i], &played);
+            return true;
+        }
+    }
+    return false;
+}
+
+/* position [startpos | fen <FEN>] [moves <m1> <m2> ...] */
+static void handlePosition(UciState *s, char **tokens, int count)
+{
+    int i = 1;
+    char fen[256] = START_FEN;
+
+    if (i < count && !strcmp(tokens[i], "fen"))
+    {
+        fen[0] = '\0';
+        for (i++; i < count && strcmp(tokens[i], "moves"); i++)
+        {
+            if (fen[0])
+                strncat(fen, " ", sizeof(fen) - strlen(fen) - 1);
+            strncat(fen, tokens[i], sizeof(fen) - strlen(fen) - 1);
+        }
+    }
+    else if (i < count && !strcmp(tokens[i], "startpos"))
+        i++;
+
+    // Set up a copy and take it only once every move is legal: a bad command leaves the position as it was
+    BoardState board;
+    if (!loadBoardFromFEN(fen, &board))
+    {
+        uciSend("info string invalid FEN, position ignored: %s\n", fen);
+        return;
+    }
+
+    if (i < count && !strcmp(tokens[i], "moves"))
+    {
+        for (i++; i < count; i++)
+        {
+            if (!playMove(&board, tokens[i]))
+            {
+                uciSend("info string illegal move, position ignored: %s\n", tokens[i]);
+                return;
+            }
+        }
+    }
+    s->board = board;
+}
+
+/* Time for this move out of 'left' ms on the clock (plus 'increment' per move) */
+static int64_t allocateTime(int64_t left, int64_t increment, int movesToGo)
+{
+    if (movesToGo <= 0)
+        movesToGo = UCI_DEFAULT_MOVES_TO_GO;
+
+    int64_t budget = left / movesToGo + increment * 3 / 4;
+    if (budget > left - UCI_MOVE_OVERHEAD)
+        budget = left - UCI_MOVE_OVERHEAD;
+    return (budget > 1) ? budget : 1;
+}
+
+/* go [wtime <ms>] [btime <ms>] [winc <ms>] [binc <ms>] [movestogo <n>]
+ *    [movetime <ms>] [depth <n>] [nodes <n>] [infinite] [ponder] */
+static void handleGo(UciState *s, char **tokens, int count)
+{
+    int64_t time[2] = {-1, -1};
+    int64_t increment[2] = {0, 0};
+    int64_t moveTime = 0;
+    int movesToGo = 0;
+    int depth = 0;
+    uint64_t nodes = 0;
+    bool infinite = false;
+    bool ponder = false;
+
+    for (int i = 1; i < count; i++)
+    {
+        bool hasValue = i + 1 < count;
+        if (!strcmp(tokens[i], "wtime") && hasValue)
+            time[WHITE] = strtoll(tokens[++i], NULL, 10);
+        else if (!strcmp(tokens[i], "btime") && hasValue)
+            time[BLACK] = strtoll(tokens[++i], NULL, 10);
+        else if (!strcmp(tokens[i], "winc") && hasValue)
+            increment[WHITE] = strtoll(tokens[++i], NULL, 10);
+        else if (!strcmp(tokens[i], "binc") && hasValue)
+            increment[BLACK] = strtoll(tokens[++i], NULL, 10);
+        else if (!strcmp(tokens[i], "movestogo") && hasValue)
+            movesToGo = atoi(tokens[++i]);
+        else if (!strcmp(tokens[i], "movetime") && hasValue)
+            moveTime = strtoll(tokens[++i], NULL, 10);
+        else if (!strcmp(tokens[i], "depth") && hasValue)
+            depth = atoi(tokens[++i]);
+        else if (!strcmp(tokens[i], "nodes") && hasValue)
+            nodes = strtoull(tokens[++i], NULL, 10);
+        else if (!strcmp(tokens[i], "infinite"))
+            infinite = true;
+        else if (!strcmp(tokens[i], "ponder"))
+            ponder = true;
+    }
+
+    stopSearch(s);
+
+    // In book: answer at once, without starting a search (unless the GUI wants several lines)
+    Move bookMove;
+    if (!infinite && !ponder && s->multiPV <= 1 && bookProbe(&s->board, &s->bookRandom, &bookMove))
+    {
+        char move[6];
+        moveToString(bookMove, move);
+        uciSend("bestmove %s\n", move);
+        return;
+    }
+
+    PieceColor us = s->board.currentPlayer;
+    int64_t budget = 0;
+    if (moveTime > 0)
+        budget = moveTime;
+    else if (!infinite && time[us] >= 0)
+        budget = allocateTime(time[us], increment[us], movesToGo);
+
+    s->searchBoard = s->board;
+    s->limits = (SearchLimits){depth, budget, nodes, &s->stop, s->threads, &s->params, &s->ponder,
+                                reportIteration, s, s->multiPV, false};
+    s->infinite = infinite;
+    atomic_store(&s->stop, false);
+    atomic_store(&s->ponder, ponder);
+
+    if (pthread_create(&s->worker, NULL, searchWorker, s) == 0)
+        s->searching = true;
+    else
+        uciSend("bestmove 0000\n");
+}
+
+/* setoption name <id> [value <x>]: the name may contain spaces */
+static void handleSetOption(UciState *s, char **tokens, int count)
+{
+    char name[64] = "";
+    const char *value = NULL;
+    int i = 1;
+
+    if (i < count && !strcmp(tokens[i], "name"))
+        i++;
+    for (; i < count && strcmp(tokens[i], "value"); i++)
+    {
+        if (name[0])
+            strncat(name, " ", sizeof(name) - strlen(name) - 1);
+        strncat(name, tokens[i], sizeof(name) - strlen(name) - 1);
+    }
+    if (i + 1 < count)
+        value = tokens[i + 1];
+
+    if (!strcmp(name, "Hash") && value)
+    {
+        // Never resize the table under a running search
+        stopSearch(s);
+        size_t megabytes = (size_t)strtoul(value, NULL, 10);
+        if (!ttInit(megabytes))
+            uciSend("info string could not allocate %zu MB, keeping %zu MB\n", megabytes, ttSizeMB());
+    }
+    else if (!strcmp(name, "Threads") && value)
+    {
+        int threads = atoi(value);
+        s->threads = (threads < 1) ? 1 : (threads > MAX_SEARCH_THREADS) ? MAX_SEARCH_THREADS : threads;
+    }
+    else if (!strcmp(name, "MultiPV") && value)
+    {
+        int lines = atoi(value);
+        s->multiPV = (lines < 1) ? 1 : (lines > MAX_MULTI_PV) ? MAX_MULTI_PV : lines;
+    }
+    else if (!strcmp(name, "BookFile") && value)
+    {
+        stopSearch(s);
+        if (!strcmp(value, "<empty>"))
+            bookFree();
+        else if (!bookInit(value))
+            uciSend("info string could not open book %s\n", value);
+    }
+    else if (!strcmp(name, "EvalFile") && value)
+    {
+        stopSearch(s);
+        if (!nnueInit(strcmp(value, "<empty>") ? value : NULL))
+            uciSend("info string could not load network %s, using the classical evaluation\n", value);
+    }
+    else if (!strcmp(name, "SyzygyPath") && value)
+    {
+        // The tables are unmapped and remapped: the search must not be probing them
+        stopSearch(s);
+        int files = tbInit(strcmp(value, "<empty>") ? value : NULL);
+        uciSend("info string %d tablebase files, up to %d pieces\n", files, tbLargest());
+    }
+    else if (!strcmp(name, "SyzygyProbeLimit") && value)
+    {
+        int limit = atoi(value);
+        s->params.tbProbeLimit = (limit < 0) ? 0 : (limit > TB_MAX_PIECES) ? TB_MAX_PIECES : limit;
+    }
+    else if (!strcmp(name, "SearchStats") && value)
+        s->showStats = !strcmp(value, "true");
+    else if (!strcmp(name, "Ponder"))
+    {
+        // Nothing to set up: the GUI decides when to send "go ponder"
+    }
+    else
+        uciSend("info string unknown option: %s\n", name);
+}
+
+/* ---------- Main Loop ---------- */
+
+int runUci(const SearchParams *params, int threads, bool uciReceived)
+{
+    static char line[UCI_LINE_LENGTH];
+    static UciState s;
+    char *tokens[UCI_MAX_TOKENS];
+
+    loadBoardFromFEN(START_FEN, &s.board);
+    s.params = *params;
+    s.threads = (threads < 1) ? 1 : threads;
+    s.multiPV = 1;
+    s.searching = false;
+    pthread_mutex_init(&s.lock, NULL);
+    pthread_cond_init(&s.released, NULL);
+
+    if (uciReceived)
+        sendIdentity(&s);
+
+    while (fgets(line, sizeof(line), stdin))
+    {
+        int count = 0;
+        for (char *tok = strtok(line, " \t\r\n"); tok && count < UCI_MAX_TOKENS; tok = strtok(NULL, " \t\r\n"))
+            tokens[count++] = tok;
+        if (count == 0)
+            continue;
+
+        const char *command = tokens[0];
+        if (!strcmp(command, "uci"))
+            sendIdentity(&s);
+        else if (!strcmp(command, "isready"))
+            uciSend("readyok\n");
+        else if (!strcmp(command, "ucinewgame"))
+        {
+            stopSearch(&s);
+            ttClear();
+            pawnHashClear();
+        }
+        else if (!strcmp(command, "position"))
+        {
+            stopSearch(&s);
+            handlePosition(&s, tokens, count);
+        }
+        else if (!strcmp(command, "go"))
+            handleGo(&s, tokens, count);
+        else if (!strcmp(command, "stop"))
+            stopSearch(&s);
+        else if (!strcmp(command, "ponderhit"))
+        {
+            // The predicted move was played: the same search goes on, now on the clock
+            pthread_mutex_lock(&s.lock);
+            atomic_store(&s.ponder, false);
+            pthread_cond_broadcast(&s.released);
+            pthread_mutex_unlock(&s.lock);
+        }
+        else if (!strcmp(command, "setoption"))
+            handleSetOption(&s, tokens, count);
+        else if (!strcmp(command, "quit"))
+            break;
+        // Anything else (debug, register, unknown) is ignored, as the protocol asks
+    }
+
+    stopSearch(&s);
+    pthread_cond_destroy(&s.released);
+    pthread_mutex_destroy(&s.lock);
+    return 0;
+}
@@ -0,0 +1,31 @@
+#ifndef UCI_H
+#define UCI_H
+
+#include <stdbool.h>
+#include "ai.h"
+
+/**
+ * @brief Runs the Universal Chess Interface on stdin/stdout until "quit" or end of input.
+ *
+ * Searches run on a worker thread, so commands such as "stop", "ponderhit"
+ * and "isready" are answered while the engine is thinking. The tables must
+ * already be allocated (ttInit, pawnHashInit).
+ *
+ * @param params Search parameters every "go" uses (e.g. from --param).
+ * @param threads Initial value of the Threads option.
+ * @param uciReceived The caller already read the opening "uci" command, so answer it at once.
+ * @return 0 when the GUI quits.
+ */
+int runUci(const SearchParams *params, int threads, bool uciReceived);
+
+#define UCI_TB_WIN_CP 20000 // Reported for a tablebase win, less the plies to reach it
+
+/**
+ * @brief Converts a search score to the units UCI reports it in.
+ * @param mate Set to true for a mate score, false for an evaluation.
+ * @return Moves to mate (negative when the side to move is mated) or
+ * centipawns, UCI_TB_WIN_CP - plies for a tablebase win.
+ */
+int uciScoreValue(int score, bool *mate);
+
+#endif // UCI_H
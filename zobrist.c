@@ -0,0 +1,86 @@
+#include "zobrist.h"
+#include <stdbool.h>
+
+uint64_t zobristPieces[2][7][64];
+uint64_t zobristCastling[16];
+uint64_t zobristEnPassant[8];
+uint64_t zobristSide;
+
+static bool initialized = false;
+
+uint64_t nextRandom(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void initZobrist(void)
+{
+    if (initialized)
+        return;
+
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+
+    for (int color = WHITE; color <= BLACK; color++)
+        for (int type = PAWN; type <= KING; type++)
+            for (int sq = 0; sq < 64; sq++)
+                zobristPieces[color][type][sq] = nextRandom(&state);
+
+    // Each rights combination gets the XOR of its individual rights, so
+    // losing one right is a single XOR of two table entries.
+    uint64_t rightKeys[4];
+    for (int i = 0; i < 4; i++)
+        rightKeys[i] = nextRandom(&state);
+    for (int mask = 0; mask < 16; mask++)
+    {
+        zobristCastling[mask] = 0;
+        for (int i = 0; i < 4; i++)
+            if (mask & (1 << i))
+                zobristCastling[mask] ^= rightKeys[i];
+    }
+
+    for (int file = 0; file < 8; file++)
+        zobristEnPassant[file] = nextRandom(&state);
+
+    zobristSide = nextRandom(&state);
+
+    initialized = true;
+}
+
+uint64_t computeHash(const BoardState *board)
+{
+    uint64_t key = 0;
+
+    for (int color = WHITE; color <= BLACK; color++)
+        for (int type = PAWN; type <= KING; type++)
+        {
+            Bitboard b = board->pieceBB[color][type];
+            while (b)
+                key ^= zobristPieces[color][type][popLsb(&b)];
+        }
+
+    key ^= zobristCastling[castlingIndex(board->castling)];
+
+    if (board->enPassantTarget.row != -1)
+        key ^= zobristEnPassant[board->enPassantTarget.col];
+
+    if (board->currentPlayer == BLACK)
+        key ^= zobristSide;
+
+    return key;
+}
+
+uint64_t computePawnKey(const BoardState *board)
+{
+    uint64_t key = 0;
+
+    for (int color = WHITE; color <= BLACK; color++)
+    {
+        Bitboard b = board->pieceBB[color][PAWN];
+        while (b)
+            key ^= zobristPieces[color][PAWN][popLsb(&b)];
+    }
+    return key;
+}
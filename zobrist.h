@@ -0,0 +1,48 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <stdint.h>
+#include "structs.h"
+
+/*
+ * Zobrist position hashing.
+ *
+ * A position key is the XOR of one random number per (color, piece, square)
+ * plus keys for the side to move, the castling-rights combination and the
+ * en passant file. makeMove/undoMove keep BoardState.hash up to date
+ * incrementally; computeHash() derives it from scratch.
+ */
+
+extern uint64_t zobristPieces[2][7][64]; // [color][PieceType][square]
+extern uint64_t zobristCastling[16];     // Indexed by castlingIndex()
+extern uint64_t zobristEnPassant[8];     // By file of the en passant target
+extern uint64_t zobristSide;             // XORed in when Black is to move
+
+/**
+ * @brief splitmix64: advances '*state' and returns the next number. Every
+ * seed gives a well-mixed, reproducible sequence.
+ */
+uint64_t nextRandom(uint64_t *state);
+
+/**
+ * @brief Fills the key tables from a fixed seed. Safe to call more than once.
+ */
+void initZobrist(void);
+
+/**
+ * @brief Full recomputation of a position's key (used on load and for verification).
+ */
+uint64_t computeHash(const BoardState *board);
+
+/**
+ * @brief Full recomputation of the pawn-only key: the XOR of the pawns' piece keys.
+ */
+uint64_t computePawnKey(const BoardState *board);
+
+/* 4-bit encoding of the castling rights: wk = 1, wq = 2, bk = 4, bq = 8 */
+static inline int castlingIndex(CastlingRights c)
+{
+    return (c.wk ? 1 : 0) | (c.wq ? 2 : 0) | (c.bk ? 4 : 0) | (c.bq ? 8 : 0);
+}
+
+#endif // ZOBRIST_H